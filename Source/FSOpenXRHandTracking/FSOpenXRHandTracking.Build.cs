@@ -22,6 +22,9 @@ public class FSOpenXRHandTracking : ModuleRules
 		PrivateDependencyModuleNames.AddRange(new [] {
 			"CoreUObject",
 			"Engine",
+			"Json",
+			"RenderCore",
+			"RHI",
 			"Slate",
 			"SlateCore"
 		});
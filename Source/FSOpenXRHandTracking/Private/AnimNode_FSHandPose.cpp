@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AnimNode_FSHandPose.h"
+#include "Animation/AnimInstance.h"
+#include "Animation/AnimInstanceProxy.h"
+#include "Animation/AnimTrace.h"
+#include "FSInstancedHand.h"
+#include "FSHandTrackingStats.h"
+
+void FAnimNode_FSHandPose::Initialize_AnyThread(const FAnimationInitializeContext& Context)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(Initialize_AnyThread);
+	FAnimNode_Base::Initialize_AnyThread(Context);
+	Source.Initialize(Context);
+
+	for (int32& BoneIndex : BoneIndices)
+		BoneIndex = INDEX_NONE;
+}
+
+void FAnimNode_FSHandPose::CacheBones_AnyThread(const FAnimationCacheBonesContext& Context)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(CacheBones_AnyThread);
+	Source.CacheBones(Context);
+
+	// Bone names are only resolved when the required bones change (LOD, mesh).
+	const FBoneContainer& RequiredBones = Context.AnimInstanceProxy->GetRequiredBones();
+
+	for (int32 i = 0; i < FSHandSkeleton::KeypointCount; i++)
+	{
+		const bool bSkipped = FSHandSkeleton::ParentIndices[i] == INDEX_NONE && !bDriveRoot;
+		BoneIndices[i] = !bSkipped && Bones[i].Initialize(RequiredBones)
+			                 ? Bones[i].GetCompactPoseIndex(RequiredBones).GetInt()
+			                 : INDEX_NONE;
+	}
+}
+
+void FAnimNode_FSHandPose::Update_AnyThread(const FAnimationUpdateContext& Context)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(Update_AnyThread);
+	GetEvaluateGraphExposedInputs().Execute(Context);
+	Source.Update(Context);
+
+	ActualAlpha = FMath::Clamp(Alpha, 0.0f, 1.0f);
+	TRACE_ANIM_NODE_VALUE(Context, TEXT("Alpha"), ActualAlpha);
+}
+
+void FAnimNode_FSHandPose::PreUpdate(const UAnimInstance* InAnimInstance)
+{
+	const UFSInstancedHand* SourceHand = Hand;
+
+	if (SourceHand == nullptr)
+	{
+		if (const AActor* Owner = InAnimInstance->GetOwningActor())
+		{
+			TInlineComponentArray<UFSInstancedHand*> Hands(Owner);
+
+			for (const UFSInstancedHand* OwnerHand : Hands)
+			{
+				if (OwnerHand->bLeftHand == bLeftHand)
+				{
+					SourceHand = OwnerHand;
+					break;
+				}
+			}
+		}
+	}
+
+	// The last pose is kept while tracking is lost.
+	if (SourceHand != nullptr && SourceHand->IsHandTracked() && SourceHand->bComputeRelativeRotations &&
+		SourceHand->DetailLevel == EFSOpenXRHandDetail::Full)
+	{
+		Rotations = SourceHand->GetPoseView().RelativeRotations;
+		bHasPose = true;
+	}
+	else if (SourceHand == nullptr)
+	{
+		bHasPose = false;
+	}
+}
+
+void FAnimNode_FSHandPose::Evaluate_AnyThread(FPoseContext& Output)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(Evaluate_AnyThread);
+	FS_HAND_TRACKING_SCOPE(AnimNodeEvaluate);
+	Source.Evaluate(Output);
+
+	if (!bHasPose || ActualAlpha <= 0.0f) return;
+
+	// Bone frames differ from the joint frames by a constant rotation, so the local rotation of a bone is
+	// Inverse(Offset) * Relative * Offset.
+	const FQuat Offset = JointToBoneRotation.Quaternion();
+	const FQuat InverseOffset = Offset.Inverse();
+
+	for (int32 i = 0; i < FSHandSkeleton::KeypointCount; i++)
+	{
+		if (BoneIndices[i] == INDEX_NONE) continue;
+
+		FTransform& Bone = Output.Pose[FCompactPoseBoneIndex(BoneIndices[i])];
+		const FQuat Rotation = InverseOffset * Rotations.GetQuat(i) * Offset;
+
+		Bone.SetRotation(ActualAlpha < 1.0f
+			                 ? FQuat::Slerp(Bone.GetRotation(), Rotation, ActualAlpha).GetNormalized()
+			                 : Rotation.GetNormalized());
+	}
+}
+
+void FAnimNode_FSHandPose::GatherDebugData(FNodeDebugData& DebugData)
+{
+	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(GatherDebugData);
+	FString DebugLine = DebugData.GetNodeName(this);
+	DebugLine += FString::Printf(TEXT("(Alpha: %.1f%% Tracked: %d)"), ActualAlpha * 100.0f, bHasPose ? 1 : 0);
+	DebugData.AddDebugItem(DebugLine);
+	Source.GatherDebugData(DebugData);
+}
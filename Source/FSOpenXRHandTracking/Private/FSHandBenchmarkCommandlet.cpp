@@ -0,0 +1,358 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FSHandBenchmarkCommandlet.h"
+#include "FSInstancedHand.h"
+#include "FSHandInstanceRenderer.h"
+#include "FSHandPoseGenerator.h"
+#include "FSHandTrackingSubsystem.h"
+#include "FSOpenXRHandTracking.h"
+#include "Dom/JsonObject.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Misc/FileHelper.h"
+#include "RenderingThread.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include <atomic>
+
+namespace
+{
+	constexpr int32 WarmupFrames = 10;
+	constexpr float BenchmarkDeltaTime = 1.0f / 90.0f;
+
+	// Forwards to the engine allocator and counts the game thread allocations while measuring.
+	// Installed once for the whole run and never destroyed, other threads may still hold it after it's removed.
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override
+		{
+			Inner->Free(Original);
+		}
+
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+		{
+			return Inner->QuantizeSize(Count, Alignment);
+		}
+
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+		{
+			return Inner->GetAllocationSize(Original, SizeOut);
+		}
+
+		virtual void Trim(bool bTrimThreadCaches) override
+		{
+			Inner->Trim(bTrimThreadCaches);
+		}
+
+		virtual bool IsInternallyThreadSafe() const override
+		{
+			return Inner->IsInternallyThreadSafe();
+		}
+
+		virtual const TCHAR* GetDescriptiveName() override
+		{
+			return TEXT("FSHandBenchmarkCountingMalloc");
+		}
+
+		FMalloc* Inner = nullptr;
+		std::atomic<bool> bMeasuring{false};
+		std::atomic<uint64> Allocations{0};
+
+	private:
+		FORCEINLINE void CountAllocation()
+		{
+			if (bMeasuring.load(std::memory_order_relaxed) && IsInGameThread())
+				Allocations.fetch_add(1, std::memory_order_relaxed);
+		}
+	};
+
+	FCountingMalloc& GetCountingMalloc()
+	{
+		static FCountingMalloc* CountingMalloc = new FCountingMalloc();
+		return *CountingMalloc;
+	}
+
+	double CyclesToNanoseconds(const uint64 Cycles)
+	{
+		return FPlatformTime::ToSeconds64(Cycles) * 1.0e9;
+	}
+}
+
+UFSHandBenchmarkCommandlet::UFSHandBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UFSHandBenchmarkCommandlet::Main(const FString& Params)
+{
+	int32 HandCount = 64;
+	int32 FrameCount = 500;
+	int32 Seed = 0;
+	float Tolerance = 0.2f;
+	FFSHandGeneratorSettings GeneratorSettings;
+	GeneratorSettings.DropoutRate = 0.0f;
+	FString CapturePath;
+	FString BaselinePath;
+
+	FParse::Value(*Params, TEXT("Hands="), HandCount);
+	FParse::Value(*Params, TEXT("Frames="), FrameCount);
+	FParse::Value(*Params, TEXT("Tolerance="), Tolerance);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("DropoutRate="), GeneratorSettings.DropoutRate);
+	FParse::Value(*Params, TEXT("Capture="), CapturePath);
+	FParse::Value(*Params, TEXT("Baseline="), BaselinePath);
+	const bool bPersistent = FParse::Param(*Params, TEXT("Persistent"));
+	const bool bShared = FParse::Param(*Params, TEXT("Shared"));
+	const bool bWriteBaseline = FParse::Param(*Params, TEXT("WriteBaseline"));
+
+	HandCount = FMath::Max(HandCount, 1);
+	FrameCount = FMath::Max(FrameCount, 1);
+
+	FFSHandPosePlayer Player;
+	if (!CapturePath.IsEmpty() && (!Player.Open(CapturePath) || Player.GetFrameCount() == 0))
+	{
+		UE_LOG(LogFSHandTracking, Error, TEXT("Unable to open capture %s"), *CapturePath);
+		return 1;
+	}
+
+	// Transient world so the hands have a scene to register their render state into.
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("FSHandBenchmark"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	AActor* Owner = World->SpawnActor<AActor>();
+	USceneComponent* Root = NewObject<USceneComponent>(Owner);
+	Owner->SetRootComponent(Root);
+	Root->RegisterComponent();
+
+	TArray<UFSInstancedHand*> Hands;
+	TArray<FXRMotionControllerData> HandData;
+	HandData.SetNum(HandCount);
+
+	for (int32 HandId = 0; HandId < HandCount; HandId++)
+	{
+		UFSInstancedHand* Hand = NewObject<UFSInstancedHand>(Owner);
+		Hand->bLeftHand = HandId % 2 == 0;
+		Hand->bPersistentInstances = bPersistent;
+		Hand->bUseSharedRenderer = bShared;
+		Hand->bComputeRelativeRotations = true;
+		Hand->HandRendering = EFSOpenXRHandRendering::InstancedMesh;
+		Hand->SetupAttachment(Root);
+		Hand->RegisterComponent();
+		Hands.Add(Hand);
+	}
+
+	FFSHandPoseGenerator Generator(HandCount, Seed, GeneratorSettings);
+	FFSHandQuatBuffer WorldQuats;
+	FFSHandQuatBuffer RelativeQuats;
+	FFSPinchDetector PinchDetector;
+
+	uint64 GenerateCycles = 0;
+	uint64 UpdateCycles = 0;
+	uint64 EndOfFrameCycles = 0;
+	uint64 RelativeCycles = 0;
+	uint64 PinchCycles = 0;
+	uint64 Allocations = 0;
+	uint64 InstanceChurn = 0;
+
+	// Instances of the shared renderers, they only grow when a hand takes a new block.
+	const UFSHandTrackingSubsystem* Subsystem = World->GetSubsystem<UFSHandTrackingSubsystem>();
+	auto GetSharedInstanceCount = [Subsystem]()
+	{
+		int32 Count = 0;
+
+		if (Subsystem != nullptr)
+		{
+			for (const UFSHandInstanceRenderer* Renderer : Subsystem->GetSharedRenderers())
+				Count += Renderer != nullptr ? Renderer->GetInstanceCount() : 0;
+		}
+
+		return Count;
+	};
+
+	// One allocator for the whole run, only the game thread allocations of the measured section are counted.
+	FCountingMalloc& CountingMalloc = GetCountingMalloc();
+	CountingMalloc.Inner = GMalloc;
+	GMalloc = &CountingMalloc;
+
+	for (int32 Frame = -WarmupFrames; Frame < FrameCount; Frame++)
+	{
+		const bool bMeasured = Frame >= 0;
+		const double Time = (Frame + WarmupFrames) * BenchmarkDeltaTime;
+
+		// Input
+		uint64 Start = FPlatformTime::Cycles64();
+
+		if (Player.IsOpen())
+		{
+			for (int32 HandId = 0; HandId < HandCount; HandId++)
+				Player.ReadFrame((Frame + WarmupFrames + HandId * 7) % Player.GetFrameCount(), HandData[HandId]);
+		}
+		else
+		{
+			Generator.Generate(Time);
+
+			for (int32 HandId = 0; HandId < HandCount; HandId++)
+				Generator.GetHandData(HandId, HandData[HandId]);
+		}
+
+		if (bMeasured)
+			GenerateCycles += FPlatformTime::Cycles64() - Start;
+
+		// UpdateHand
+		CountingMalloc.Allocations.store(0, std::memory_order_relaxed);
+		CountingMalloc.bMeasuring.store(true, std::memory_order_relaxed);
+
+		const int32 SharedInstancesBefore = GetSharedInstanceCount();
+		Start = FPlatformTime::Cycles64();
+
+		for (int32 HandId = 0; HandId < HandCount; HandId++)
+		{
+			const int32 InstancesBefore = Hands[HandId]->GetInstanceCount();
+			Hands[HandId]->UpdateHand(HandData[HandId], BenchmarkDeltaTime);
+			const int32 InstancesAfter = Hands[HandId]->GetInstanceCount();
+
+			// The non persistent mode recreates every visible instance.
+			if (bMeasured)
+				InstanceChurn += bPersistent ? FMath::Abs(InstancesAfter - InstancesBefore) : InstancesAfter;
+		}
+
+		const uint64 UpdateEnd = FPlatformTime::Cycles64();
+		CountingMalloc.bMeasuring.store(false, std::memory_order_relaxed);
+
+		if (bMeasured)
+			InstanceChurn += FMath::Abs(GetSharedInstanceCount() - SharedInstancesBefore);
+
+		// Render state updates queued by the instance changes
+		World->SendAllEndOfFrameUpdates();
+		const uint64 EndOfFrameEnd = FPlatformTime::Cycles64();
+
+		if (bMeasured)
+		{
+			UpdateCycles += UpdateEnd - Start;
+			EndOfFrameCycles += EndOfFrameEnd - UpdateEnd;
+			Allocations += CountingMalloc.Allocations.load(std::memory_order_relaxed);
+		}
+
+		// Relative rotations
+		Start = FPlatformTime::Cycles64();
+
+		for (int32 HandId = 0; HandId < HandCount; HandId++)
+		{
+			WorldQuats.Load(HandData[HandId].HandKeyRotations);
+			FSHandPose::ComputeRelativeRotations(WorldQuats, RelativeQuats);
+		}
+
+		if (bMeasured)
+			RelativeCycles += FPlatformTime::Cycles64() - Start;
+
+		// Pinch detection
+		Start = FPlatformTime::Cycles64();
+
+		for (int32 HandId = 0; HandId < HandCount; HandId++)
+			PinchDetector.Update(HandData[HandId].HandKeyPositions, 1.5f, 2.0f, 6.0f);
+
+		if (bMeasured)
+			PinchCycles += FPlatformTime::Cycles64() - Start;
+
+		FlushRenderingCommands();
+	}
+
+	const double HandFrames = static_cast<double>(HandCount) * FrameCount;
+
+	TArray<TPair<FString, double>> Results;
+	Results.Emplace(TEXT("InputNsPerHand"), CyclesToNanoseconds(GenerateCycles) / HandFrames);
+	Results.Emplace(TEXT("UpdateHandNsPerHand"), CyclesToNanoseconds(UpdateCycles) / HandFrames);
+	Results.Emplace(TEXT("EndOfFrameUpdatesNsPerHand"), CyclesToNanoseconds(EndOfFrameCycles) / HandFrames);
+	Results.Emplace(TEXT("RelativeRotationsNsPerHand"), CyclesToNanoseconds(RelativeCycles) / HandFrames);
+	Results.Emplace(TEXT("PinchNsPerHand"), CyclesToNanoseconds(PinchCycles) / HandFrames);
+	Results.Emplace(TEXT("AllocationsPerFrame"), static_cast<double>(Allocations) / FrameCount);
+	Results.Emplace(TEXT("InstanceChurnPerFrame"), static_cast<double>(InstanceChurn) / FrameCount);
+
+	UE_LOG(LogFSHandTracking, Display, TEXT("FSHandBenchmark: %d hands, %d frames, %s instances, %s input (seed %d)"),
+	       HandCount, FrameCount, bShared ? TEXT("shared") : bPersistent ? TEXT("persistent") : TEXT("rebuilt"),
+	       Player.IsOpen() ? *CapturePath : TEXT("synthetic"), Seed);
+
+	for (const TPair<FString, double>& Result : Results)
+		UE_LOG(LogFSHandTracking, Display, TEXT("  %-32s %12.2f"), *Result.Key, Result.Value);
+
+#if !WITH_METAXR
+	UE_LOG(LogFSHandTracking, Display, TEXT("  GetDataFromSkeleton is skipped, MetaXR support is disabled"));
+#endif
+
+	for (UFSInstancedHand* Hand : Hands)
+		Hand->DestroyComponent();
+
+	Owner->Destroy();
+	GMalloc = CountingMalloc.Inner;
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+
+	if (BaselinePath.IsEmpty()) return 0;
+
+	if (bWriteBaseline)
+	{
+		const TSharedRef<FJsonObject> Baseline = MakeShared<FJsonObject>();
+
+		for (const TPair<FString, double>& Result : Results)
+			Baseline->SetNumberField(Result.Key, Result.Value);
+
+		FString Json;
+		const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+		FJsonSerializer::Serialize(Baseline, Writer);
+
+		if (!FFileHelper::SaveStringToFile(Json, *BaselinePath))
+		{
+			UE_LOG(LogFSHandTracking, Error, TEXT("Unable to write baseline %s"), *BaselinePath);
+			return 1;
+		}
+
+		return 0;
+	}
+
+	FString Json;
+	TSharedPtr<FJsonObject> Baseline;
+
+	if (!FFileHelper::LoadFileToString(Json, *BaselinePath) ||
+		!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Baseline) || !Baseline.IsValid())
+	{
+		UE_LOG(LogFSHandTracking, Error, TEXT("Unable to read baseline %s"), *BaselinePath);
+		return 1;
+	}
+
+	bool bRegressed = false;
+
+	for (const TPair<FString, double>& Result : Results)
+	{
+		double Expected = 0.0;
+		if (!Baseline->TryGetNumberField(Result.Key, Expected)) continue;
+
+		if (Result.Value > Expected * (1.0 + Tolerance))
+		{
+			UE_LOG(LogFSHandTracking, Error, TEXT("%s regressed: %.2f (baseline %.2f, tolerance %.0f%%)"),
+			       *Result.Key, Result.Value, Expected, Tolerance * 100.0f);
+			bRegressed = true;
+		}
+	}
+
+	return bRegressed ? 1 : 0;
+}
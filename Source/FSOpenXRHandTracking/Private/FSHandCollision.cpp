@@ -0,0 +1,306 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FSHandCollision.h"
+#include "CollisionShape.h"
+#include "Components/PrimitiveComponent.h"
+
+namespace
+{
+	// Bounds of padding lanes, never overlap anything.
+	constexpr float EmptyMin = 1.0e30f;
+	constexpr float EmptyMax = -1.0e30f;
+
+	template <typename FunctorType>
+	FORCEINLINE void ForEachBit(uint32 Mask, FunctorType&& Functor)
+	{
+		for (; Mask != 0; Mask &= Mask - 1)
+			Functor(static_cast<int32>(FMath::CountTrailingZeros(Mask)));
+	}
+
+	// Box splatted in every lane.
+	struct FBoxLanes
+	{
+		VectorRegister4Float MinX, MinY, MinZ, MaxX, MaxY, MaxZ;
+
+		explicit FBoxLanes(const FBox3f& Box)
+			: MinX(VectorSetFloat1(Box.Min.X)), MinY(VectorSetFloat1(Box.Min.Y)), MinZ(VectorSetFloat1(Box.Min.Z))
+			, MaxX(VectorSetFloat1(Box.Max.X)), MaxY(VectorSetFloat1(Box.Max.Y)), MaxZ(VectorSetFloat1(Box.Max.Z))
+		{
+		}
+
+		// One bit per overlapping box among the 4 at Base.
+		FORCEINLINE uint32 Overlap(const float* InMinX, const float* InMinY, const float* InMinZ, const float* InMaxX,
+		                           const float* InMaxY, const float* InMaxZ, const int32 Base) const
+		{
+			VectorRegister4Float Overlaps = VectorBitwiseAnd(VectorCompareLE(MinX, VectorLoadAligned(&InMaxX[Base])),
+			                                                 VectorCompareGE(MaxX, VectorLoadAligned(&InMinX[Base])));
+			Overlaps = VectorBitwiseAnd(Overlaps, VectorCompareLE(MinY, VectorLoadAligned(&InMaxY[Base])));
+			Overlaps = VectorBitwiseAnd(Overlaps, VectorCompareGE(MaxY, VectorLoadAligned(&InMinY[Base])));
+			Overlaps = VectorBitwiseAnd(Overlaps, VectorCompareLE(MinZ, VectorLoadAligned(&InMaxZ[Base])));
+			Overlaps = VectorBitwiseAnd(Overlaps, VectorCompareGE(MaxZ, VectorLoadAligned(&InMinZ[Base])));
+			return static_cast<uint32>(VectorMaskBits(Overlaps));
+		}
+	};
+}
+
+FFSInteractableSet::FFSInteractableSet()
+	: Version(0)
+{
+}
+
+void FFSInteractableSet::Add(UPrimitiveComponent* Component)
+{
+	if (Component == nullptr || Components.Contains(Component)) return;
+
+	Components.Add(Component);
+
+	const int32 LaneCount = Align(Components.Num(), 4);
+
+	for (TArray<float, TAlignedHeapAllocator<16>>* Lanes : {&MinX, &MinY, &MinZ, &MaxX, &MaxY, &MaxZ})
+		Lanes->SetNum(LaneCount, EAllowShrinking::No);
+
+	for (int32 i = Components.Num() - 1; i < LaneCount; i++)
+		SetBounds(i, FBox3f(ForceInit));
+
+	SetBounds(Components.Num() - 1, FBox3f(Component->Bounds.GetBox()));
+	Version++;
+}
+
+void FFSInteractableSet::Remove(const UPrimitiveComponent* Component)
+{
+	const int32 Index = Components.IndexOfByPredicate([Component](const TWeakObjectPtr<UPrimitiveComponent>& Other)
+	{
+		return Other.Get() == Component;
+	});
+
+	if (Index != INDEX_NONE)
+		RemoveAt(Index);
+}
+
+void FFSInteractableSet::RemoveAt(const int32 Index)
+{
+	const int32 LastIndex = Components.Num() - 1;
+	Components.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+
+	// The last object moved to Index.
+	if (Index != LastIndex)
+	{
+		MinX[Index] = MinX[LastIndex];
+		MinY[Index] = MinY[LastIndex];
+		MinZ[Index] = MinZ[LastIndex];
+		MaxX[Index] = MaxX[LastIndex];
+		MaxY[Index] = MaxY[LastIndex];
+		MaxZ[Index] = MaxZ[LastIndex];
+	}
+
+	SetBounds(LastIndex, FBox3f(ForceInit));
+	Version++;
+}
+
+void FFSInteractableSet::RefreshBounds()
+{
+	for (int32 i = Components.Num() - 1; i >= 0; i--)
+	{
+		if (!Components[i].IsValid())
+			RemoveAt(i);
+	}
+
+	bool bChanged = false;
+
+	for (int32 i = 0; i < Components.Num(); i++)
+	{
+		const FBox3f Box(Components[i]->Bounds.GetBox());
+
+		if (Box.Min.X != MinX[i] || Box.Min.Y != MinY[i] || Box.Min.Z != MinZ[i] ||
+			Box.Max.X != MaxX[i] || Box.Max.Y != MaxY[i] || Box.Max.Z != MaxZ[i])
+		{
+			SetBounds(i, Box);
+			bChanged = true;
+		}
+	}
+
+	if (bChanged)
+		Version++;
+}
+
+void FFSInteractableSet::Overlap(const FBox3f& Box, TArray<int32>& OutIndices) const
+{
+	const FBoxLanes BoxLanes(Box);
+
+	for (int32 Base = 0; Base < MinX.Num(); Base += 4)
+	{
+		const uint32 Overlaps = BoxLanes.Overlap(MinX.GetData(), MinY.GetData(), MinZ.GetData(), MaxX.GetData(),
+		                                         MaxY.GetData(), MaxZ.GetData(), Base);
+
+		ForEachBit(Overlaps, [&OutIndices, Base](const int32 Lane)
+		{
+			OutIndices.Add(Base + Lane);
+		});
+	}
+}
+
+void FFSInteractableSet::SetBounds(const int32 Index, const FBox3f& Box)
+{
+	const bool bEmpty = !Box.IsValid;
+	MinX[Index] = bEmpty ? EmptyMin : Box.Min.X;
+	MinY[Index] = bEmpty ? EmptyMin : Box.Min.Y;
+	MinZ[Index] = bEmpty ? EmptyMin : Box.Min.Z;
+	MaxX[Index] = bEmpty ? EmptyMax : Box.Max.X;
+	MaxY[Index] = bEmpty ? EmptyMax : Box.Max.Y;
+	MaxZ[Index] = bEmpty ? EmptyMax : Box.Max.Z;
+}
+
+void FFSHandCollision::Update(const FVector* Locations, const float* Radii, const FFSInteractableSet& Set,
+                              const float StaticThreshold, FContactCallback OnContact)
+{
+	constexpr int32 Count = FSHandSkeleton::KeypointCount;
+
+	// Contacts can't change if nothing moved.
+	if (bHasLastLocations && LastVersion == Set.GetVersion())
+	{
+		const double ThresholdSquared = FMath::Square(StaticThreshold);
+		bool bMoved = false;
+
+		for (int32 i = 0; i < Count && !bMoved; i++)
+			bMoved = FVector::DistSquared(Locations[i], LastLocations[i]) > ThresholdSquared;
+
+		if (!bMoved) return;
+	}
+
+	FBox3f HandBox(ForceInit);
+	float MaxRadius = 0.0f;
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		LastLocations[i] = Locations[i];
+		HandBox += FVector3f(Locations[i]);
+		MaxRadius = FMath::Max(MaxRadius, Radii[i]);
+	}
+
+	// Capsule bounds, computed once and tested against every candidate.
+	for (int32 Keypoint = 0; Keypoint < CapsuleLaneCount; Keypoint++)
+	{
+		const int32 Parent = Keypoint < Count ? FSHandSkeleton::ParentIndices[Keypoint] : INDEX_NONE;
+
+		if (Parent == INDEX_NONE)
+		{
+			CapsuleMinX[Keypoint] = CapsuleMinY[Keypoint] = CapsuleMinZ[Keypoint] = EmptyMin;
+			CapsuleMaxX[Keypoint] = CapsuleMaxY[Keypoint] = CapsuleMaxZ[Keypoint] = EmptyMax;
+			continue;
+		}
+
+		const FVector3f Start(Locations[Parent]);
+		const FVector3f End(Locations[Keypoint]);
+		const float Radius = FMath::Max(Radii[Keypoint], Radii[Parent]);
+		const FVector3f Min = Start.ComponentMin(End) - Radius;
+		const FVector3f Max = Start.ComponentMax(End) + Radius;
+
+		CapsuleRadii[Keypoint] = Radius;
+		CapsuleMinX[Keypoint] = Min.X;
+		CapsuleMinY[Keypoint] = Min.Y;
+		CapsuleMinZ[Keypoint] = Min.Z;
+		CapsuleMaxX[Keypoint] = Max.X;
+		CapsuleMaxY[Keypoint] = Max.Y;
+		CapsuleMaxZ[Keypoint] = Max.Z;
+	}
+
+	LastVersion = Set.GetVersion();
+	bHasLastLocations = true;
+
+	// Broadphase, whole hand against every object.
+	Candidates.Reset();
+	Set.Overlap(HandBox.ExpandBy(MaxRadius), Candidates);
+
+	NewContacts.Reset();
+
+	for (const int32 Candidate : Candidates)
+	{
+		UPrimitiveComponent* Component = Set.GetComponent(Candidate);
+
+		if (Component == nullptr) continue;
+
+		// Capsule bounds against the object bounds.
+		const FBoxLanes ObjectLanes(Set.GetBounds(Candidate));
+		uint32 CapsuleMask = 0;
+
+		for (int32 Base = 0; Base < CapsuleLaneCount; Base += 4)
+		{
+			CapsuleMask |= ObjectLanes.Overlap(CapsuleMinX, CapsuleMinY, CapsuleMinZ, CapsuleMaxX, CapsuleMaxY,
+			                                   CapsuleMaxZ, Base) << Base;
+		}
+
+		uint32 KeypointMask = 0;
+
+		ForEachBit(CapsuleMask, [&](const int32 Keypoint)
+		{
+			const FVector& Start = Locations[FSHandSkeleton::ParentIndices[Keypoint]];
+			const FVector& End = Locations[Keypoint];
+			const float Radius = CapsuleRadii[Keypoint];
+
+			// Narrowphase, capsules are aligned on Z.
+			const FVector Axis = End - Start;
+			const double Length = Axis.Size();
+			const FQuat Rotation = Length > UE_KINDA_SMALL_NUMBER
+				                       ? FQuat::FindBetweenNormals(FVector::UpVector, Axis / Length)
+				                       : FQuat::Identity;
+			const FCollisionShape Capsule = FCollisionShape::MakeCapsule(
+				Radius, static_cast<float>(Length * 0.5) + Radius);
+
+			if (Component->OverlapComponent((Start + End) * 0.5, Rotation, Capsule))
+				KeypointMask |= 1u << Keypoint;
+		});
+
+		if (KeypointMask != 0)
+			NewContacts.Add({Component, KeypointMask});
+	}
+
+	SetContacts(OnContact);
+}
+
+void FFSHandCollision::Clear(FContactCallback OnContact)
+{
+	NewContacts.Reset();
+	SetContacts(OnContact);
+	bHasLastLocations = false;
+}
+
+void FFSHandCollision::SetContacts(FContactCallback OnContact)
+{
+	// Ended contacts first, then new ones.
+	for (const FContact& Contact : Contacts)
+	{
+		const FContact* NewContact = NewContacts.FindByPredicate([&Contact](const FContact& Other)
+		{
+			return Other.Component == Contact.Component;
+		});
+
+		UPrimitiveComponent* Component = Contact.Component.Get();
+		const uint32 Ended = Contact.KeypointMask & ~(NewContact != nullptr ? NewContact->KeypointMask : 0);
+
+		if (Component != nullptr)
+		{
+			ForEachBit(Ended, [&OnContact, Component](const int32 Keypoint)
+			{
+				OnContact(Component, Keypoint, false);
+			});
+		}
+	}
+
+	for (const FContact& NewContact : NewContacts)
+	{
+		const FContact* Contact = Contacts.FindByPredicate([&NewContact](const FContact& Other)
+		{
+			return Other.Component == NewContact.Component;
+		});
+
+		UPrimitiveComponent* Component = NewContact.Component.Get();
+		const uint32 Began = NewContact.KeypointMask & ~(Contact != nullptr ? Contact->KeypointMask : 0);
+
+		ForEachBit(Began, [&OnContact, Component](const int32 Keypoint)
+		{
+			OnContact(Component, Keypoint, true);
+		});
+	}
+
+	Swap(Contacts, NewContacts);
+}
@@ -0,0 +1,220 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FSHandGestureLibrary.h"
+#include "InputAction.h"
+
+namespace
+{
+	// Padding templates are far away from any real feature vector.
+	constexpr float PaddingValue = 1.0e6f;
+
+	FORCEINLINE float GetAngle(const FQuat& Quat)
+	{
+		return 2.0f * FMath::Acos(FMath::Clamp(static_cast<float>(FMath::Abs(Quat.W)), 0.0f, 1.0f));
+	}
+
+	// Rotation of a keypoint relative to the palm, composed from the relative rotations of its parents.
+	FQuat GetPalmSpaceRotation(const FFSHandQuatBuffer& RelativeRotations, const int32 Keypoint)
+	{
+		FQuat Rotation = RelativeRotations.GetQuat(Keypoint);
+
+		for (int32 Parent = FSHandSkeleton::ParentIndices[Keypoint];
+		     Parent != FSHandSkeleton::Palm && Parent != INDEX_NONE; Parent = FSHandSkeleton::ParentIndices[Parent])
+			Rotation = RelativeRotations.GetQuat(Parent) * Rotation;
+
+		return Rotation;
+	}
+
+	// Bones point along X and the back of the hand along Z, the spread is measured in the palm plane.
+	FORCEINLINE float GetPlanarAngle(const FVector& A, const FVector& B)
+	{
+		const float AngleA = static_cast<float>(FMath::Atan2(A.Y, A.X));
+		const float AngleB = static_cast<float>(FMath::Atan2(B.Y, B.X));
+		return FMath::Abs(FMath::FindDeltaAngleRadians(AngleA, AngleB));
+	}
+}
+
+void FFSHandGestureFeatures::ToArray(float OutValues[FeatureCount]) const
+{
+	OutValues[0] = ThumbCurl;
+	OutValues[1] = IndexCurl;
+	OutValues[2] = MiddleCurl;
+	OutValues[3] = RingCurl;
+	OutValues[4] = LittleCurl;
+	OutValues[5] = ThumbIndexSplay;
+	OutValues[6] = IndexMiddleSplay;
+	OutValues[7] = MiddleRingSplay;
+	OutValues[8] = RingLittleSplay;
+	OutValues[9] = ThumbOpposition;
+}
+
+FFSHandGestureFeatures FFSHandGestureFeatures::FromRelativeRotations(const FFSHandQuatBuffer& RelativeRotations)
+{
+	FFSHandGestureFeatures Features;
+	float Curls[FSHandSkeleton::FingerCount];
+	float Splays[FSHandSkeleton::FingerCount - 1];
+	FVector ProximalDirections[FSHandSkeleton::FingerCount];
+
+	for (int32 Finger = 0; Finger < FSHandSkeleton::FingerCount; Finger++)
+	{
+		const int32 Start = FSHandSkeleton::FingerStartIndices[Finger];
+		const int32 Tip = FSHandSkeleton::FingerTipIndices[Finger];
+
+		// Bend of every joint between the metacarpal and the tip.
+		float Bend = 0.0f;
+
+		for (int32 Keypoint = Start + 1; Keypoint < Tip; Keypoint++)
+			Bend += GetAngle(RelativeRotations.GetQuat(Keypoint));
+
+		Curls[Finger] = Bend / ((Tip - Start - 1) * UE_HALF_PI);
+		ProximalDirections[Finger] = GetPalmSpaceRotation(RelativeRotations, Start + 1).GetForwardVector();
+	}
+
+	for (int32 Finger = 0; Finger < FSHandSkeleton::FingerCount - 1; Finger++)
+		Splays[Finger] = GetPlanarAngle(ProximalDirections[Finger], ProximalDirections[Finger + 1]) / UE_HALF_PI;
+
+	// 1 when the thumb distal points into the palm.
+	const FVector ThumbDirection = GetPalmSpaceRotation(RelativeRotations, FSHandSkeleton::ThumbTip - 1).GetForwardVector();
+	Features.ThumbOpposition = static_cast<float>(0.5 * (1.0 - ThumbDirection.Z));
+
+	Features.ThumbCurl = Curls[0];
+	Features.IndexCurl = Curls[1];
+	Features.MiddleCurl = Curls[2];
+	Features.RingCurl = Curls[3];
+	Features.LittleCurl = Curls[4];
+	Features.ThumbIndexSplay = Splays[0];
+	Features.IndexMiddleSplay = Splays[1];
+	Features.MiddleRingSplay = Splays[2];
+	Features.RingLittleSplay = Splays[3];
+
+	return Features;
+}
+
+int32 UFSHandGestureLibrary::FindNearest(const FFSHandGestureFeatures& Features, float& OutScore)
+{
+	OutScore = MAX_flt;
+
+	if (bCacheDirty)
+		BuildCache();
+
+	if (PaddedCount == 0)
+		return INDEX_NONE;
+
+	float Values[FFSHandGestureFeatures::FeatureCount];
+	Features.ToArray(Values);
+
+	VectorRegister4Float FeatureValues[FFSHandGestureFeatures::FeatureCount];
+
+	for (int32 Feature = 0; Feature < FFSHandGestureFeatures::FeatureCount; Feature++)
+		FeatureValues[Feature] = VectorSetFloat1(Values[Feature]);
+
+	// 4 templates per iteration, the best score and index of each lane are kept.
+	VectorRegister4Float BestScores = VectorSetFloat1(MAX_flt);
+	VectorRegister4Float BestIndices = VectorZero();
+	VectorRegister4Float Indices = MakeVectorRegisterFloat(0.0f, 1.0f, 2.0f, 3.0f);
+	const VectorRegister4Float Four = VectorSetFloat1(4.0f);
+	const float* ColumnData = Columns.GetData();
+
+	for (int32 Template = 0; Template < PaddedCount; Template += 4)
+	{
+		VectorRegister4Float DistanceSquared = VectorZero();
+
+		for (int32 Feature = 0; Feature < FFSHandGestureFeatures::FeatureCount; Feature++)
+		{
+			const VectorRegister4Float Delta = VectorSubtract(
+				VectorLoadAligned(ColumnData + Feature * PaddedCount + Template), FeatureValues[Feature]);
+			DistanceSquared = VectorMultiplyAdd(Delta, Delta, DistanceSquared);
+		}
+
+		const VectorRegister4Float Score = VectorMultiply(DistanceSquared,
+		                                                  VectorLoadAligned(&InvToleranceSquared[Template]));
+		const VectorRegister4Float Closer = VectorCompareLT(Score, BestScores);
+		BestScores = VectorSelect(Closer, Score, BestScores);
+		BestIndices = VectorSelect(Closer, Indices, BestIndices);
+		Indices = VectorAdd(Indices, Four);
+	}
+
+	alignas(16) float LaneScores[4];
+	alignas(16) float LaneIndices[4];
+	VectorStoreAligned(BestScores, LaneScores);
+	VectorStoreAligned(BestIndices, LaneIndices);
+
+	int32 BestIndex = INDEX_NONE;
+
+	for (int32 Lane = 0; Lane < 4; Lane++)
+	{
+		if (LaneScores[Lane] < OutScore)
+		{
+			OutScore = LaneScores[Lane];
+			BestIndex = static_cast<int32>(LaneIndices[Lane]);
+		}
+	}
+
+	// Distance relative to the tolerance of the template.
+	OutScore = FMath::Sqrt(OutScore);
+	return BestIndex < Gestures.Num() ? BestIndex : INDEX_NONE;
+}
+
+float UFSHandGestureLibrary::GetScore(const int32 Gesture, const FFSHandGestureFeatures& Features) const
+{
+	if (!Gestures.IsValidIndex(Gesture)) return MAX_flt;
+
+	float Values[FFSHandGestureFeatures::FeatureCount];
+	float TemplateValues[FFSHandGestureFeatures::FeatureCount];
+	Features.ToArray(Values);
+	Gestures[Gesture].Features.ToArray(TemplateValues);
+
+	float DistanceSquared = 0.0f;
+
+	for (int32 Feature = 0; Feature < FFSHandGestureFeatures::FeatureCount; Feature++)
+		DistanceSquared += FMath::Square(Values[Feature] - TemplateValues[Feature]);
+
+	return FMath::Sqrt(DistanceSquared) / FMath::Max(Gestures[Gesture].Tolerance, UE_KINDA_SMALL_NUMBER);
+}
+
+void UFSHandGestureLibrary::PostLoad()
+{
+	Super::PostLoad();
+	bCacheDirty = true;
+}
+
+#if WITH_EDITOR
+void UFSHandGestureLibrary::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	bCacheDirty = true;
+}
+#endif
+
+void UFSHandGestureLibrary::BuildCache()
+{
+	check(IsInGameThread());
+
+	PaddedCount = Align(Gestures.Num(), 4);
+	Columns.SetNumUninitialized(FFSHandGestureFeatures::FeatureCount * PaddedCount);
+	InvToleranceSquared.SetNumUninitialized(PaddedCount);
+
+	for (int32 Template = 0; Template < PaddedCount; Template++)
+	{
+		float Values[FFSHandGestureFeatures::FeatureCount];
+
+		if (Gestures.IsValidIndex(Template))
+		{
+			Gestures[Template].Features.ToArray(Values);
+			InvToleranceSquared[Template] = 1.0f / FMath::Square(FMath::Max(Gestures[Template].Tolerance,
+			                                                                 UE_KINDA_SMALL_NUMBER));
+		}
+		else
+		{
+			for (float& Value : Values)
+				Value = PaddingValue;
+
+			InvToleranceSquared[Template] = 1.0f;
+		}
+
+		for (int32 Feature = 0; Feature < FFSHandGestureFeatures::FeatureCount; Feature++)
+			Columns[Feature * PaddedCount + Template] = Values[Feature];
+	}
+
+	bCacheDirty = false;
+}
@@ -0,0 +1,266 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FSHandGestureSubsystem.h"
+#include "EnhancedInputSubsystems.h"
+#include "FSHandTrackingStats.h"
+#include "FSHandTrackingSubsystem.h"
+#include "FSInstancedHand.h"
+#include "InputAction.h"
+#include "InputModifiers.h"
+#include "InputTriggers.h"
+#include "Kismet/GameplayStatics.h"
+
+void UFSHandGestureSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	// Gestures are evaluated once the hands are updated, in the same frame.
+	UFSHandTrackingSubsystem* Subsystem = Collection.InitializeDependency<UFSHandTrackingSubsystem>();
+
+	if (Subsystem != nullptr)
+	{
+		TrackingSubsystem = Subsystem;
+		HandsUpdatedHandle = Subsystem->OnHandsUpdated.AddUObject(this, &UFSHandGestureSubsystem::EvaluateGestures);
+	}
+
+	Super::Initialize(Collection);
+}
+
+void UFSHandGestureSubsystem::Deinitialize()
+{
+	if (UFSHandTrackingSubsystem* Subsystem = TrackingSubsystem.Get())
+		Subsystem->OnHandsUpdated.Remove(HandsUpdatedHandle);
+
+	HandsUpdatedHandle.Reset();
+	TrackingSubsystem.Reset();
+	ExitAll();
+	HandStates.Empty();
+	Super::Deinitialize();
+}
+
+bool UFSHandGestureSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UFSHandGestureSubsystem::EvaluateGestures(const float DeltaTime)
+{
+	FS_HAND_TRACKING_SCOPE(Gestures);
+
+	// Forget destroyed hands, their injections are still stopped.
+	for (int32 i = HandStates.Num() - 1; i >= 0; i--)
+	{
+		if (!HandStates[i].Hand.IsValid())
+		{
+			SetGesture(HandStates[i], INDEX_NONE);
+			HandStates.RemoveAtSwap(i);
+		}
+	}
+
+	const UFSHandTrackingSubsystem* Subsystem = TrackingSubsystem.Get();
+
+	if (Subsystem == nullptr) return;
+
+	for (UFSInstancedHand* Hand : Subsystem->GetRegisteredHands())
+	{
+		if (Hand == nullptr) continue;
+
+		FHandState& State = FindOrAddState(Hand);
+		int32 Gesture = INDEX_NONE;
+
+		if (Library != nullptr && Hand->IsHandTracked() && Hand->bComputeRelativeRotations &&
+			Hand->DetailLevel == EFSOpenXRHandDetail::Full)
+		{
+			const FFSHandGestureFeatures Features = GetHandFeatures(Hand);
+			float Score;
+			const int32 Nearest = Library->FindNearest(Features, Score);
+
+			// Hysteresis, the current gesture is kept slightly outside of its tolerance.
+			const float MaxScore = Nearest == State.Gesture ? ExitToleranceScale : 1.0f;
+
+			if (Nearest != INDEX_NONE && Score <= MaxScore)
+			{
+				Gesture = Nearest;
+			}
+			// A nearer template that isn't recognized doesn't end the current gesture, neighbor templates would flicker.
+			else if (State.Gesture != INDEX_NONE && Nearest != State.Gesture &&
+				Library->GetScore(State.Gesture, Features) <= ExitToleranceScale)
+			{
+				Gesture = State.Gesture;
+			}
+		}
+
+		if (Gesture != State.Gesture)
+		{
+			SetGesture(State, Gesture);
+		}
+		else if (State.Gesture != INDEX_NONE)
+		{
+			State.Duration += DeltaTime;
+			OnGestureStay.Broadcast(Hand, State.GestureName, State.Duration);
+		}
+
+		if (MotionLibrary != nullptr)
+			UpdateMotions(Hand, State);
+	}
+}
+
+void UFSHandGestureSubsystem::SetLibrary(UFSHandGestureLibrary* InLibrary)
+{
+	if (Library == InLibrary) return;
+
+	ExitAll();
+	Library = InLibrary;
+}
+
+void UFSHandGestureSubsystem::SetMotionLibrary(UFSHandMotionLibrary* InLibrary)
+{
+	if (MotionLibrary == InLibrary) return;
+
+	MotionLibrary = InLibrary;
+
+	for (FHandState& State : HandStates)
+	{
+		State.MotionMatcher.Reset();
+		State.MotionFrame = 0;
+	}
+}
+
+FName UFSHandGestureSubsystem::GetCurrentGesture(const UFSInstancedHand* Hand) const
+{
+	const FHandState* State = HandStates.FindByPredicate([Hand](const FHandState& InState)
+	{
+		return InState.Hand.Get() == Hand;
+	});
+
+	return State != nullptr ? State->GestureName : NAME_None;
+}
+
+FFSHandGestureFeatures UFSHandGestureSubsystem::GetHandFeatures(const UFSInstancedHand* Hand)
+{
+	return Hand != nullptr ? Hand->GetGestureFeatures() : FFSHandGestureFeatures();
+}
+
+FVector UFSHandGestureSubsystem::GetHandMotionFeature(const UFSInstancedHand* Hand)
+{
+	const FFSHandPoseHistory* History = Hand != nullptr ? Hand->GetPoseHistory() : nullptr;
+
+	if (History == nullptr || History->Num() == 0)
+		return FVector::ZeroVector;
+
+	const FVector3f& Velocity = History->GetSample(0).Velocities[FSHandSkeleton::Palm];
+	return Hand->GetComponentTransform().InverseTransformVectorNoScale(FVector(Velocity));
+}
+
+UFSHandGestureSubsystem::FHandState& UFSHandGestureSubsystem::FindOrAddState(UFSInstancedHand* Hand)
+{
+	for (FHandState& State : HandStates)
+	{
+		if (State.Hand.Get() == Hand)
+			return State;
+	}
+
+	FHandState& State = HandStates.AddDefaulted_GetRef();
+	State.Hand = Hand;
+	return State;
+}
+
+void UFSHandGestureSubsystem::SetGesture(FHandState& State, const int32 Gesture)
+{
+	UFSInstancedHand* Hand = State.Hand.Get();
+
+	// Exit
+	if (State.Gesture != INDEX_NONE)
+	{
+		if (const UInputAction* Action = State.InjectedAction.Get())
+		{
+			if (UEnhancedInputLocalPlayerSubsystem* Subsystem = GetInputSubsystem())
+			{
+				Subsystem->StopContinuousInputInjectionForAction(Action);
+				FS_HAND_TRACKING_COUNT(InputInjections, 1);
+			}
+		}
+
+		const FName PreviousName = State.GestureName;
+
+		State.Gesture = INDEX_NONE;
+		State.GestureName = NAME_None;
+		State.InjectedAction.Reset();
+
+		if (Hand != nullptr)
+			OnGestureExit.Broadcast(Hand, PreviousName);
+	}
+
+	if (Gesture == INDEX_NONE || Library == nullptr || !Library->Gestures.IsValidIndex(Gesture)) return;
+
+	// Enter
+	const FFSHandGestureTemplate& Template = Library->Gestures[Gesture];
+	State.Gesture = Gesture;
+	State.GestureName = Template.Name;
+	State.Duration = 0.0f;
+
+	if (Template.InputAction != nullptr)
+	{
+		if (UEnhancedInputLocalPlayerSubsystem* Subsystem = GetInputSubsystem())
+		{
+			Subsystem->StartContinuousInputInjectionForAction(Template.InputAction, FInputActionValue(1.0f),
+			                                                  TArray<UInputModifier*>(), TArray<UInputTrigger*>());
+			State.InjectedAction = Template.InputAction;
+			FS_HAND_TRACKING_COUNT(InputInjections, 1);
+		}
+	}
+
+	OnGestureEnter.Broadcast(Hand, State.GestureName);
+}
+
+void UFSHandGestureSubsystem::UpdateMotions(UFSInstancedHand* Hand, FHandState& State)
+{
+	const FFSHandPoseHistory* History = Hand->GetPoseHistory();
+	const int64 PushCount = History != nullptr ? History->GetPushCount() : 0;
+
+	// Tracking was lost, the history restarted.
+	if (PushCount < State.MotionFrame || PushCount == 0)
+	{
+		State.MotionMatcher.Reset();
+		State.MotionFrame = 0;
+	}
+
+	if (PushCount == 0) return;
+
+	const FTransform& HandTransform = Hand->GetComponentTransform();
+
+	// Usually one new sample per tick, older ones are fed if the hand was updated several times.
+	const int64 FirstFrame = FMath::Max(State.MotionFrame + 1, PushCount - History->Num() + 1);
+
+	for (int64 Frame = FirstFrame; Frame <= PushCount; Frame++)
+	{
+		const FFSHandPoseHistory::FSample& Sample = History->GetSample(static_cast<int32>(PushCount - Frame));
+		const FVector3f Feature(
+			HandTransform.InverseTransformVectorNoScale(FVector(Sample.Velocities[FSHandSkeleton::Palm])));
+
+		State.MotionMatcher.Update(*MotionLibrary, Feature, Frame,
+		                           [this, Hand](const int32 Template, float, int64, int64)
+		                           {
+			                           OnMotionGesture.Broadcast(Hand, MotionLibrary->Motions[Template].Name);
+		                           });
+	}
+
+	State.MotionFrame = PushCount;
+}
+
+void UFSHandGestureSubsystem::ExitAll()
+{
+	for (FHandState& State : HandStates)
+		SetGesture(State, INDEX_NONE);
+}
+
+UEnhancedInputLocalPlayerSubsystem* UFSHandGestureSubsystem::GetInputSubsystem()
+{
+	if (!InputSubsystem.IsValid())
+	{
+		const APlayerController* PC = UGameplayStatics::GetPlayerController(GetWorld(), 0);
+
+		if (PC != nullptr)
+			InputSubsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PC->GetLocalPlayer());
+	}
+
+	return InputSubsystem.Get();
+}
@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FSHandInstanceRenderer.h"
+#include "FSHandTrackingStats.h"
+
+UFSHandInstanceRenderer::UFSHandInstanceRenderer()
+{
+	NumCustomDataFloats = CustomDataCount;
+	SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetCanEverAffectNavigation(false);
+	HiddenTransforms.Init(FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector), BlockSize);
+}
+
+int32 UFSHandInstanceRenderer::AllocateBlock()
+{
+	if (FreeBlocks.Num() > 0)
+		return FreeBlocks.Pop(EAllowShrinking::No);
+
+	const int32 Block = GetBlockCount();
+	AddInstances(HiddenTransforms, false, true);
+	BlockCustomData.AddZeroed(CustomDataCount);
+
+	// Hand id is the block index, it's set once for the lifetime of the block.
+	const float CustomData[CustomDataCount] = {static_cast<float>(Block)};
+
+	for (int32 i = 0; i < BlockSize; i++)
+		SetCustomData(Block * BlockSize + i, MakeArrayView(CustomData), false);
+
+	BlockCustomData[Block * CustomDataCount] = CustomData[0];
+	return Block;
+}
+
+void UFSHandInstanceRenderer::FreeBlock(const int32 Block)
+{
+	if (Block < 0 || Block >= GetBlockCount() || FreeBlocks.Contains(Block)) return;
+
+	HideBlock(Block);
+	FreeBlocks.Add(Block);
+}
+
+void UFSHandInstanceRenderer::UpdateBlock(const int32 Block, const TArray<FTransform>& Transforms,
+                                          const FLinearColor& Color)
+{
+	check(Transforms.Num() == BlockSize);
+
+	BatchUpdateInstancesTransforms(Block * BlockSize, Transforms, true, true);
+	SetBlockCustomData(Block, Color, true);
+	FS_HAND_TRACKING_COUNT(InstancesTouched, BlockSize);
+}
+
+void UFSHandInstanceRenderer::HideBlock(const int32 Block)
+{
+	const float* CustomData = &BlockCustomData[Block * CustomDataCount];
+
+	BatchUpdateInstancesTransforms(Block * BlockSize, HiddenTransforms, true, true);
+	SetBlockCustomData(Block, FLinearColor(CustomData[1], CustomData[2], CustomData[3]), false);
+	FS_HAND_TRACKING_COUNT(InstancesTouched, BlockSize);
+}
+
+void UFSHandInstanceRenderer::SetBlockCustomData(const int32 Block, const FLinearColor& Color, const bool bTracked)
+{
+	float* CustomData = &BlockCustomData[Block * CustomDataCount];
+	const float NewData[CustomDataCount] = {CustomData[0], Color.R, Color.G, Color.B, bTracked ? 1.0f : 0.0f};
+
+	if (FMemory::Memcmp(CustomData, NewData, sizeof(NewData)) == 0) return;
+
+	FMemory::Memcpy(CustomData, NewData, sizeof(NewData));
+
+	for (int32 i = 0; i < BlockSize; i++)
+		SetCustomData(Block * BlockSize + i, MakeArrayView(NewData), false);
+
+	MarkRenderStateDirty();
+}
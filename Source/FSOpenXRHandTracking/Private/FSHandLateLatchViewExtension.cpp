@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FSHandLateLatchViewExtension.h"
+#include "FSHandPosePipeline.h"
+#include "FSOpenXRHandTracking.h"
+#include "RenderingThread.h"
+
+FFSHandLateLatchViewExtension::FFSHandLateLatchViewExtension(const FAutoRegister& AutoRegister)
+	: FSceneViewExtensionBase(AutoRegister)
+{
+}
+
+TSharedPtr<FFSHandLateLatchViewExtension, ESPMode::ThreadSafe> FFSHandLateLatchViewExtension::Get()
+{
+	FFSOpenXRHandTrackingModule* Module =
+		FModuleManager::GetModulePtr<FFSOpenXRHandTrackingModule>(TEXT("FSOpenXRHandTracking"));
+
+	return Module != nullptr ? Module->GetLateLatchViewExtension() : nullptr;
+}
+
+void FFSHandLateLatchViewExtension::Register(const TSharedRef<FFSHandPosePipeline, ESPMode::ThreadSafe>& Pipeline)
+{
+	ENQUEUE_RENDER_COMMAND(FSHandRegisterLateLatch)(
+		[Extension = StaticCastSharedRef<FFSHandLateLatchViewExtension>(AsShared()), Pipeline](FRHICommandListImmediate&)
+		{
+			Extension->Pipelines.AddUnique(Pipeline);
+		});
+}
+
+void FFSHandLateLatchViewExtension::Unregister(const TSharedRef<FFSHandPosePipeline, ESPMode::ThreadSafe>& Pipeline)
+{
+	ENQUEUE_RENDER_COMMAND(FSHandUnregisterLateLatch)(
+		[Extension = StaticCastSharedRef<FFSHandLateLatchViewExtension>(AsShared()), Pipeline](FRHICommandListImmediate&)
+		{
+			Extension->Pipelines.Remove(Pipeline);
+		});
+}
+
+void FFSHandLateLatchViewExtension::PreRenderViewFamily_RenderThread(FRDGBuilder& GraphBuilder,
+                                                                     FSceneViewFamily& InViewFamily)
+{
+	for (const TSharedRef<FFSHandPosePipeline, ESPMode::ThreadSafe>& Pipeline : Pipelines)
+		Pipeline->LatchRenderThread();
+}
@@ -0,0 +1,207 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FSHandMotionLibrary.h"
+
+namespace
+{
+	FVector SampleTemplate(const TArray<FVector>& Samples, const float Position)
+	{
+		const int32 Index = FMath::Min(FMath::FloorToInt32(Position), Samples.Num() - 1);
+		const int32 NextIndex = FMath::Min(Index + 1, Samples.Num() - 1);
+		return FMath::Lerp(Samples[Index], Samples[NextIndex], Position - Index);
+	}
+}
+
+void UFSHandMotionLibrary::UpdateCache()
+{
+	check(IsInGameThread());
+
+	if (!bCacheDirty)
+		return;
+
+	const int32 Count = Motions.Num();
+	X.SetNumUninitialized(Count * TemplateLength);
+	Y.SetNumUninitialized(Count * TemplateLength);
+	Z.SetNumUninitialized(Count * TemplateLength);
+	MaxCosts.SetNumUninitialized(Count);
+
+	for (int32 Template = 0; Template < Count; Template++)
+	{
+		const FFSHandMotionTemplate& Motion = Motions[Template];
+
+		for (int32 i = 0; i < TemplateLength; i++)
+		{
+			// Linear resampling over the sample indices.
+			const FVector Sample = Motion.Samples.Num() > 0
+				                       ? SampleTemplate(Motion.Samples, static_cast<float>(i * (Motion.Samples.Num() - 1))
+				                                        / (TemplateLength - 1))
+				                       : FVector::ZeroVector;
+
+			X[Template * TemplateLength + i] = static_cast<float>(Sample.X);
+			Y[Template * TemplateLength + i] = static_cast<float>(Sample.Y);
+			Z[Template * TemplateLength + i] = static_cast<float>(Sample.Z);
+		}
+
+		// Templates without samples never match.
+		MaxCosts[Template] = Motion.Samples.Num() > 0 ? FMath::Square(Motion.Threshold) * TemplateLength : -1.0f;
+	}
+
+	Version++;
+	bCacheDirty = false;
+}
+
+void UFSHandMotionLibrary::PostLoad()
+{
+	Super::PostLoad();
+	bCacheDirty = true;
+}
+
+#if WITH_EDITOR
+void UFSHandMotionLibrary::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	bCacheDirty = true;
+}
+#endif
+
+void FFSHandMotionMatcher::Reset()
+{
+	for (FTemplateState& State : States)
+		ResetState(State);
+}
+
+void FFSHandMotionMatcher::ResetState(FTemplateState& State)
+{
+	for (int32 i = 0; i < TemplateLength; i++)
+	{
+		State.Costs[i] = MAX_flt;
+		State.Starts[i] = INDEX_NONE;
+	}
+
+	State.BestCost = MAX_flt;
+	State.BestStart = INDEX_NONE;
+	State.BestEnd = INDEX_NONE;
+}
+
+void FFSHandMotionMatcher::Update(UFSHandMotionLibrary& Library, const FVector3f& Feature, const int64 Frame,
+                                  TFunctionRef<void(int32 Template, float Cost, int64 StartFrame, int64 EndFrame)>
+                                  OnMatch)
+{
+	Library.UpdateCache();
+
+	// States are only reallocated when the library changes.
+	if (BoundLibrary.Get() != &Library || BoundVersion != Library.GetVersion())
+	{
+		States.SetNumUninitialized(Library.GetTemplateCount());
+		Reset();
+		BoundLibrary = &Library;
+		BoundVersion = Library.GetVersion();
+	}
+
+	const VectorRegister4Float FeatureX = VectorSetFloat1(Feature.X);
+	const VectorRegister4Float FeatureY = VectorSetFloat1(Feature.Y);
+	const VectorRegister4Float FeatureZ = VectorSetFloat1(Feature.Z);
+
+	for (int32 Template = 0; Template < States.Num(); Template++)
+	{
+		FTemplateState& State = States[Template];
+		const float MaxCost = Library.GetMaxCost(Template);
+
+		// Local distances to every template sample, 4 at a time.
+		alignas(16) float Distances[TemplateLength];
+		const float* X = Library.GetX(Template);
+		const float* Y = Library.GetY(Template);
+		const float* Z = Library.GetZ(Template);
+
+		for (int32 i = 0; i < TemplateLength; i += 4)
+		{
+			const VectorRegister4Float DX = VectorSubtract(VectorLoadAligned(X + i), FeatureX);
+			const VectorRegister4Float DY = VectorSubtract(VectorLoadAligned(Y + i), FeatureY);
+			const VectorRegister4Float DZ = VectorSubtract(VectorLoadAligned(Z + i), FeatureZ);
+			VectorRegister4Float DistanceSquared = VectorMultiply(DX, DX);
+			DistanceSquared = VectorMultiplyAdd(DY, DY, DistanceSquared);
+			DistanceSquared = VectorMultiplyAdd(DZ, DZ, DistanceSquared);
+			VectorStoreAligned(DistanceSquared, &Distances[i]);
+		}
+
+		// New cost column. A match can start at any frame, so the cell before the first sample is free.
+		float Left = 0.0f;
+		int64 LeftStart = Frame;
+		float Diagonal = 0.0f;
+		int64 DiagonalStart = Frame;
+
+		for (int32 i = 0; i < TemplateLength; i++)
+		{
+			const float Up = State.Costs[i];
+			const int64 UpStart = State.Starts[i];
+
+			float Best = Left;
+			int64 BestStart = LeftStart;
+
+			if (Diagonal < Best)
+			{
+				Best = Diagonal;
+				BestStart = DiagonalStart;
+			}
+
+			if (Up < Best)
+			{
+				Best = Up;
+				BestStart = UpStart;
+			}
+
+			Diagonal = Up;
+			DiagonalStart = UpStart;
+
+			Left = Best < MAX_flt ? Best + Distances[i] : MAX_flt;
+			LeftStart = BestStart;
+			State.Costs[i] = Left;
+			State.Starts[i] = LeftStart;
+		}
+
+		// The candidate is final when no cell overlapping it can still beat it, or when it waited long enough.
+		if (State.BestEnd != INDEX_NONE)
+		{
+			bool bFinal = Frame - State.BestEnd >= Library.MaxReportDelay;
+
+			if (!bFinal)
+			{
+				bFinal = true;
+
+				for (int32 i = 0; i < TemplateLength; i++)
+				{
+					if (State.Costs[i] < State.BestCost && State.Starts[i] <= State.BestEnd)
+					{
+						bFinal = false;
+						break;
+					}
+				}
+			}
+
+			if (bFinal)
+			{
+				OnMatch(Template, State.BestCost, State.BestStart, State.BestEnd);
+
+				// Overlapping paths are discarded so the same motion isn't reported twice.
+				for (int32 i = 0; i < TemplateLength; i++)
+				{
+					if (State.Starts[i] <= State.BestEnd)
+						State.Costs[i] = MAX_flt;
+				}
+
+				State.BestCost = MAX_flt;
+				State.BestStart = INDEX_NONE;
+				State.BestEnd = INDEX_NONE;
+			}
+		}
+
+		const float EndCost = State.Costs[TemplateLength - 1];
+
+		if (EndCost <= MaxCost && EndCost < State.BestCost)
+		{
+			State.BestCost = EndCost;
+			State.BestStart = State.Starts[TemplateLength - 1];
+			State.BestEnd = Frame;
+		}
+	}
+}
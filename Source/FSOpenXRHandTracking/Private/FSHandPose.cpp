@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FSHandPose.h"
+
+namespace
+{
+	constexpr int32 IdentityLane = FSHandSkeleton::KeypointCount;
+
+	static_assert(FFSHandQuatBuffer::LaneCount > FSHandSkeleton::KeypointCount, "An identity lane is required");
+
+	// Parent lane of each lane, roots and padding lanes point to an identity lane.
+	struct FParentLanes
+	{
+		int32 Indices[FFSHandQuatBuffer::LaneCount];
+
+		constexpr FParentLanes() : Indices()
+		{
+			for (int32 Lane = 0; Lane < FFSHandQuatBuffer::LaneCount; ++Lane)
+			{
+				const int32 Parent = Lane < FSHandSkeleton::KeypointCount
+					                     ? FSHandSkeleton::ParentIndices[Lane]
+					                     : INDEX_NONE;
+				Indices[Lane] = Parent == INDEX_NONE ? IdentityLane : Parent;
+			}
+		}
+	};
+
+	constexpr FParentLanes ParentLanes;
+}
+
+FFSHandQuatBuffer::FFSHandQuatBuffer()
+{
+	Reset();
+}
+
+void FFSHandQuatBuffer::Reset()
+{
+	for (int32 Lane = 0; Lane < LaneCount; ++Lane)
+	{
+		X[Lane] = 0.0f;
+		Y[Lane] = 0.0f;
+		Z[Lane] = 0.0f;
+		W[Lane] = 1.0f;
+	}
+}
+
+void FFSHandQuatBuffer::Load(TConstArrayView<FQuat> Rotations)
+{
+	const int32 Count = FMath::Min(Rotations.Num(), FSHandSkeleton::KeypointCount);
+
+	for (int32 Index = 0; Index < Count; ++Index)
+		SetQuat(Index, Rotations[Index]);
+}
+
+void FSHandPose::ComputeRelativeRotations(const FFSHandQuatBuffer& WorldRotations,
+                                          FFSHandQuatBuffer& OutRelativeRotations)
+{
+	// Gather parent rotations so the product below is a pure lane-wise operation.
+	FFSHandQuatBuffer Parents;
+
+	for (int32 Lane = 0; Lane < FFSHandQuatBuffer::LaneCount; ++Lane)
+	{
+		const int32 ParentLane = ParentLanes.Indices[Lane];
+		const bool bIdentity = ParentLane == IdentityLane;
+		Parents.X[Lane] = bIdentity ? 0.0f : WorldRotations.X[ParentLane];
+		Parents.Y[Lane] = bIdentity ? 0.0f : WorldRotations.Y[ParentLane];
+		Parents.Z[Lane] = bIdentity ? 0.0f : WorldRotations.Z[ParentLane];
+		Parents.W[Lane] = bIdentity ? 1.0f : WorldRotations.W[ParentLane];
+	}
+
+	// Conjugate(P) * B, 4 joints per iteration.
+	for (int32 Lane = 0; Lane < FFSHandQuatBuffer::LaneCount; Lane += 4)
+	{
+		const VectorRegister4Float PX = VectorLoadAligned(&Parents.X[Lane]);
+		const VectorRegister4Float PY = VectorLoadAligned(&Parents.Y[Lane]);
+		const VectorRegister4Float PZ = VectorLoadAligned(&Parents.Z[Lane]);
+		const VectorRegister4Float PW = VectorLoadAligned(&Parents.W[Lane]);
+		const VectorRegister4Float BX = VectorLoadAligned(&WorldRotations.X[Lane]);
+		const VectorRegister4Float BY = VectorLoadAligned(&WorldRotations.Y[Lane]);
+		const VectorRegister4Float BZ = VectorLoadAligned(&WorldRotations.Z[Lane]);
+		const VectorRegister4Float BW = VectorLoadAligned(&WorldRotations.W[Lane]);
+
+		// w = Pw*Bw + Px*Bx + Py*By + Pz*Bz
+		VectorRegister4Float RW = VectorMultiply(PW, BW);
+		RW = VectorMultiplyAdd(PX, BX, RW);
+		RW = VectorMultiplyAdd(PY, BY, RW);
+		RW = VectorMultiplyAdd(PZ, BZ, RW);
+
+		// x = Pw*Bx - Px*Bw - Py*Bz + Pz*By
+		VectorRegister4Float RX = VectorMultiply(PW, BX);
+		RX = VectorNegateMultiplyAdd(PX, BW, RX);
+		RX = VectorNegateMultiplyAdd(PY, BZ, RX);
+		RX = VectorMultiplyAdd(PZ, BY, RX);
+
+		// y = Pw*By + Px*Bz - Py*Bw - Pz*Bx
+		VectorRegister4Float RY = VectorMultiply(PW, BY);
+		RY = VectorMultiplyAdd(PX, BZ, RY);
+		RY = VectorNegateMultiplyAdd(PY, BW, RY);
+		RY = VectorNegateMultiplyAdd(PZ, BX, RY);
+
+		// z = Pw*Bz - Px*By + Py*Bx - Pz*Bw
+		VectorRegister4Float RZ = VectorMultiply(PW, BZ);
+		RZ = VectorNegateMultiplyAdd(PX, BY, RZ);
+		RZ = VectorMultiplyAdd(PY, BX, RZ);
+		RZ = VectorNegateMultiplyAdd(PZ, BW, RZ);
+
+		VectorStoreAligned(RX, &OutRelativeRotations.X[Lane]);
+		VectorStoreAligned(RY, &OutRelativeRotations.Y[Lane]);
+		VectorStoreAligned(RZ, &OutRelativeRotations.Z[Lane]);
+		VectorStoreAligned(RW, &OutRelativeRotations.W[Lane]);
+	}
+}
+
+void FSHandPose::ComputeRelativeRotations(TConstArrayView<FFSHandQuatBuffer> WorldRotations,
+                                          TArrayView<FFSHandQuatBuffer> OutRelativeRotations)
+{
+	check(WorldRotations.Num() == OutRelativeRotations.Num());
+
+	for (int32 HandIndex = 0; HandIndex < WorldRotations.Num(); ++HandIndex)
+		ComputeRelativeRotations(WorldRotations[HandIndex], OutRelativeRotations[HandIndex]);
+}
@@ -0,0 +1,468 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FSHandPoseArchive.h"
+#include "FSOpenXRHandTracking.h"
+#include "HAL/FileManager.h"
+
+namespace
+{
+	// Columns: timestamp, state, then position XYZ, rotation XYZW and radius of each joint.
+	constexpr int32 JointColumnCount = 8;
+	constexpr int32 TimeColumn = 0;
+	constexpr int32 StateColumn = 1;
+	constexpr int32 FirstJointColumn = 2;
+	constexpr int32 ColumnCount = FirstJointColumn + FSHandSkeleton::KeypointCount * JointColumnCount;
+
+	// 1/100 cm, 1/32767 per rotation component, 1 us.
+	constexpr float PositionScale = 100.0f;
+	constexpr float RotationScale = 32767.0f;
+	constexpr double TimeScale = 1000000.0;
+
+	FORCEINLINE uint32 ZigZag(const int32 Value)
+	{
+		return (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31);
+	}
+
+	FORCEINLINE int32 UnZigZag(const uint32 Value)
+	{
+		return static_cast<int32>(Value >> 1) ^ -static_cast<int32>(Value & 1);
+	}
+
+	void WriteVarint(TArray<uint8>& Out, uint32 Value)
+	{
+		while (Value >= 0x80)
+		{
+			Out.Add(static_cast<uint8>(Value) | 0x80);
+			Value >>= 7;
+		}
+
+		Out.Add(static_cast<uint8>(Value));
+	}
+
+	bool ReadVarint(const uint8*& Data, const uint8* End, uint32& OutValue)
+	{
+		OutValue = 0;
+
+		for (int32 Shift = 0; Shift < 35 && Data < End; Shift += 7)
+		{
+			const uint8 Byte = *Data++;
+			OutValue |= static_cast<uint32>(Byte & 0x7f) << Shift;
+
+			if ((Byte & 0x80) == 0) return true;
+		}
+
+		return false;
+	}
+
+	// Untracked frames repeat the joints of the previous frame, their deltas are 0.
+	// Rotations are kept in the hemisphere of the previous frame so the deltas stay small.
+	void QuantizeFrame(const FFSHandPoseFrame& Frame, const int32* Previous, const double ChunkStartTime,
+	                   int32* OutValues)
+	{
+		OutValues[TimeColumn] = static_cast<int32>(FMath::Clamp(
+			FMath::RoundToDouble((Frame.Timestamp - ChunkStartTime) * TimeScale), 0.0, static_cast<double>(MAX_int32)));
+		OutValues[StateColumn] = Frame.bValid | Frame.TrackingStatus << 1 | Frame.HandIndex << 3;
+
+		int32* Joints = OutValues + FirstJointColumn;
+
+		if (Frame.bValid == 0)
+		{
+			if (Previous != nullptr)
+				FMemory::Memcpy(Joints, Previous + FirstJointColumn, sizeof(int32) * (ColumnCount - FirstJointColumn));
+			else
+				FMemory::Memzero(Joints, sizeof(int32) * (ColumnCount - FirstJointColumn));
+
+			return;
+		}
+
+		for (int32 i = 0; i < FSHandSkeleton::KeypointCount; i++)
+		{
+			int32* Values = Joints + i * JointColumnCount;
+			float Sign = 1.0f;
+
+			if (Previous != nullptr)
+			{
+				const int32* PreviousRotation = Previous + FirstJointColumn + i * JointColumnCount + 3;
+				float Dot = 0.0f;
+
+				for (int32 c = 0; c < 4; c++)
+					Dot += PreviousRotation[c] * Frame.Rotations[i][c];
+
+				Sign = Dot < 0.0f ? -1.0f : 1.0f;
+			}
+
+			for (int32 c = 0; c < 3; c++)
+				Values[c] = FMath::RoundToInt32(Frame.Positions[i][c] * PositionScale);
+
+			for (int32 c = 0; c < 4; c++)
+			{
+				const float Component = FMath::Clamp(Frame.Rotations[i][c] * Sign, -1.0f, 1.0f);
+				Values[3 + c] = FMath::RoundToInt32(Component * RotationScale);
+			}
+
+			Values[7] = FMath::RoundToInt32(Frame.Radii[i] * PositionScale);
+		}
+	}
+
+	void DequantizeFrame(const int32* Values, const double ChunkStartTime, FFSHandPoseFrame& OutFrame)
+	{
+		FMemory::Memzero(OutFrame);
+
+		OutFrame.Timestamp = ChunkStartTime + Values[TimeColumn] / TimeScale;
+		OutFrame.bValid = Values[StateColumn] & 1;
+		OutFrame.TrackingStatus = (Values[StateColumn] >> 1) & 3;
+		OutFrame.HandIndex = static_cast<uint8>(Values[StateColumn] >> 3);
+
+		for (int32 i = 0; i < FSHandSkeleton::KeypointCount; i++)
+		{
+			const int32* Joint = Values + FirstJointColumn + i * JointColumnCount;
+
+			for (int32 c = 0; c < 3; c++)
+				OutFrame.Positions[i][c] = Joint[c] / PositionScale;
+
+			FQuat4f Rotation(Joint[3] / RotationScale, Joint[4] / RotationScale, Joint[5] / RotationScale,
+			                 Joint[6] / RotationScale);
+			Rotation.Normalize();
+			OutFrame.Rotations[i][0] = Rotation.X;
+			OutFrame.Rotations[i][1] = Rotation.Y;
+			OutFrame.Rotations[i][2] = Rotation.Z;
+			OutFrame.Rotations[i][3] = Rotation.W;
+			OutFrame.Radii[i] = Joint[7] / PositionScale;
+		}
+	}
+
+	FORCEINLINE FVector3f GetPosition(const FFSHandPoseFrame& Frame, const int32 Keypoint)
+	{
+		return FVector3f(Frame.Positions[Keypoint][0], Frame.Positions[Keypoint][1], Frame.Positions[Keypoint][2]);
+	}
+}
+
+FFSHandArchiveFeatures FFSHandArchiveFeatures::Compute(const FFSHandPoseFrame& Frame,
+                                                       const FFSHandPoseFrame* Previous)
+{
+	FFSHandArchiveFeatures Features;
+	Features.bTracked = Frame.bValid != 0;
+
+	if (!Features.bTracked) return Features;
+
+	const FVector3f ThumbTip = GetPosition(Frame, FSHandSkeleton::ThumbTip);
+
+	for (int32 Finger = 0; Finger < FFSPinchDetector::FingerCount; Finger++)
+	{
+		Features.PinchDistances[Finger] = FVector3f::Dist(
+			ThumbTip, GetPosition(Frame, FSHandSkeleton::GetPinchTipIndex(Finger)));
+	}
+
+	if (Previous != nullptr && Previous->bValid != 0 && Frame.Timestamp > Previous->Timestamp)
+	{
+		Features.PalmSpeed = static_cast<float>(
+			FVector3f::Dist(GetPosition(Frame, FSHandSkeleton::Palm), GetPosition(*Previous, FSHandSkeleton::Palm)) /
+			(Frame.Timestamp - Previous->Timestamp));
+	}
+
+	return Features;
+}
+
+bool FFSHandArchiveQuery::MatchesChunk(const FFSHandArchiveChunk& Chunk) const
+{
+	if (Chunk.EndTime < StartTime || Chunk.StartTime > EndTime) return false;
+	if (bTrackingLost && Chunk.TrackedFrameCount == Chunk.FrameCount) return false;
+	if (bTracked && Chunk.TrackedFrameCount == 0) return false;
+
+	// Both ranges are empty (Min > Max) without tracked frames.
+	if (PinchFinger >= 0 && PinchFinger < FFSPinchDetector::FingerCount &&
+		Chunk.MinPinchDistances[PinchFinger] > PinchDistance)
+		return false;
+
+	return MinPalmSpeed <= 0.0f || Chunk.MaxPalmSpeed >= MinPalmSpeed;
+}
+
+bool FFSHandArchiveQuery::MatchesFrame(const FFSHandPoseFrame& Frame, const FFSHandArchiveFeatures& Features) const
+{
+	const bool bPinchQuery = PinchFinger >= 0 && PinchFinger < FFSPinchDetector::FingerCount;
+
+	if (Frame.Timestamp < StartTime || Frame.Timestamp > EndTime) return false;
+	if (bTrackingLost && Features.bTracked) return false;
+	if ((bTracked || bPinchQuery || MinPalmSpeed > 0.0f) && !Features.bTracked) return false;
+	if (bPinchQuery && Features.PinchDistances[PinchFinger] > PinchDistance) return false;
+
+	return MinPalmSpeed <= 0.0f || Features.PalmSpeed >= MinPalmSpeed;
+}
+
+FFSHandPoseArchiveWriter::~FFSHandPoseArchiveWriter()
+{
+	Close();
+}
+
+bool FFSHandPoseArchiveWriter::Open(const FString& Filename, const int32 InChunkFrameCount)
+{
+	Close();
+
+	Writer.Reset(IFileManager::Get().CreateFileWriter(*Filename));
+	if (!Writer.IsValid()) return false;
+
+	ChunkFrameCount = FMath::Max(InChunkFrameCount, 1);
+	PendingFrames.Reset(ChunkFrameCount);
+	Chunks.Reset();
+
+	// The index offset is patched on Close.
+	FFSHandPoseArchiveHeader Header;
+	FMemory::Memzero(Header);
+	Writer->Serialize(&Header, sizeof(Header));
+
+	StartTime = FPlatformTime::Seconds();
+	FrameCount = 0;
+	return true;
+}
+
+void FFSHandPoseArchiveWriter::Close()
+{
+	if (!Writer.IsValid()) return;
+
+	FlushChunk();
+
+	FFSHandPoseArchiveHeader Header;
+	Header.Magic = FFSHandPoseArchiveHeader::ExpectedMagic;
+	Header.Version = FFSHandPoseArchiveHeader::CurrentVersion;
+	Header.ChunkFrameCount = ChunkFrameCount;
+	Header.KeypointCount = FSHandSkeleton::KeypointCount;
+	Header.IndexOffset = Writer->Tell();
+	Header.ChunkCount = Chunks.Num();
+	Header.Reserved = 0;
+
+	Writer->Serialize(Chunks.GetData(), Chunks.Num() * sizeof(FFSHandArchiveChunk));
+	Writer->Seek(0);
+	Writer->Serialize(&Header, sizeof(Header));
+	Writer->Close();
+	Writer.Reset();
+}
+
+void FFSHandPoseArchiveWriter::Record(const FXRMotionControllerData& InData)
+{
+	if (!Writer.IsValid()) return;
+
+	FFSHandPoseFrame Frame;
+	Frame.Store(InData, FPlatformTime::Seconds() - StartTime);
+	RecordFrame(Frame);
+}
+
+void FFSHandPoseArchiveWriter::RecordFrame(const FFSHandPoseFrame& Frame)
+{
+	if (!Writer.IsValid()) return;
+
+	PendingFrames.Add(Frame);
+	FrameCount++;
+
+	if (PendingFrames.Num() >= ChunkFrameCount)
+		FlushChunk();
+}
+
+void FFSHandPoseArchiveWriter::FlushChunk()
+{
+	const int32 Count = PendingFrames.Num();
+	if (Count == 0) return;
+
+	FFSHandArchiveChunk Chunk;
+	FMemory::Memzero(Chunk);
+	Chunk.Offset = Writer->Tell();
+	Chunk.FrameCount = Count;
+	Chunk.StartTime = PendingFrames[0].Timestamp;
+	Chunk.EndTime = PendingFrames.Last().Timestamp;
+	Chunk.MinPalmSpeed = MAX_flt;
+	Chunk.MaxPalmSpeed = -MAX_flt;
+
+	for (int32 Finger = 0; Finger < FFSPinchDetector::FingerCount; Finger++)
+	{
+		Chunk.MinPinchDistances[Finger] = MAX_flt;
+		Chunk.MaxPinchDistances[Finger] = -MAX_flt;
+	}
+
+	Values.SetNumUninitialized(Count * ColumnCount, EAllowShrinking::No);
+
+	// Features are computed on the decoded frames so the index agrees with the reader.
+	FFSHandPoseFrame Decoded[2];
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		int32* Row = &Values[i * ColumnCount];
+		QuantizeFrame(PendingFrames[i], i > 0 ? Row - ColumnCount : nullptr, Chunk.StartTime, Row);
+
+		FFSHandPoseFrame& Frame = Decoded[i & 1];
+		DequantizeFrame(Row, Chunk.StartTime, Frame);
+
+		const FFSHandArchiveFeatures Features = FFSHandArchiveFeatures::Compute(
+			Frame, i > 0 ? &Decoded[(i - 1) & 1] : nullptr);
+
+		if (!Features.bTracked) continue;
+
+		Chunk.TrackedFrameCount++;
+		Chunk.MinPalmSpeed = FMath::Min(Chunk.MinPalmSpeed, Features.PalmSpeed);
+		Chunk.MaxPalmSpeed = FMath::Max(Chunk.MaxPalmSpeed, Features.PalmSpeed);
+
+		for (int32 Finger = 0; Finger < FFSPinchDetector::FingerCount; Finger++)
+		{
+			const float Distance = Features.PinchDistances[Finger];
+			Chunk.MinPinchDistances[Finger] = FMath::Min(Chunk.MinPinchDistances[Finger], Distance);
+			Chunk.MaxPinchDistances[Finger] = FMath::Max(Chunk.MaxPinchDistances[Finger], Distance);
+		}
+	}
+
+	// Column major, the first value of a column is its keyframe.
+	ChunkData.Reset();
+
+	for (int32 Column = 0; Column < ColumnCount; Column++)
+	{
+		int32 Previous = 0;
+
+		for (int32 i = 0; i < Count; i++)
+		{
+			const int32 Value = Values[i * ColumnCount + Column];
+			WriteVarint(ChunkData, ZigZag(Value - Previous));
+			Previous = Value;
+		}
+	}
+
+	Writer->Serialize(ChunkData.GetData(), ChunkData.Num());
+	Chunk.Size = ChunkData.Num();
+	Chunks.Add(Chunk);
+	PendingFrames.Reset();
+}
+
+bool FFSHandPoseArchiveWriter::ConvertCapture(const FString& CaptureFilename, const FString& ArchiveFilename,
+                                              const int32 InChunkFrameCount)
+{
+	FFSHandPosePlayer Player;
+	FFSHandPoseArchiveWriter ArchiveWriter;
+
+	if (!Player.Open(CaptureFilename) || !ArchiveWriter.Open(ArchiveFilename, InChunkFrameCount)) return false;
+
+	for (int32 i = 0; i < Player.GetFrameCount(); i++)
+		ArchiveWriter.RecordFrame(Player.GetFrame(i));
+
+	ArchiveWriter.Close();
+	return true;
+}
+
+bool FFSHandPoseArchiveReader::Open(const FString& Filename)
+{
+	Close();
+
+	Reader.Reset(IFileManager::Get().CreateFileReader(*Filename));
+	if (!Reader.IsValid()) return false;
+
+	const int64 FileSize = Reader->TotalSize();
+	FFSHandPoseArchiveHeader Header;
+
+	if (FileSize < static_cast<int64>(sizeof(Header)))
+	{
+		Close();
+		return false;
+	}
+
+	Reader->Serialize(&Header, sizeof(Header));
+
+	// A zero index offset means the writer wasn't closed.
+	if (Header.Magic != FFSHandPoseArchiveHeader::ExpectedMagic ||
+		Header.Version != FFSHandPoseArchiveHeader::CurrentVersion ||
+		Header.KeypointCount != FSHandSkeleton::KeypointCount ||
+		Header.IndexOffset < static_cast<int64>(sizeof(Header)) ||
+		Header.IndexOffset + static_cast<int64>(Header.ChunkCount) * sizeof(FFSHandArchiveChunk) > FileSize)
+	{
+		UE_LOG(LogFSHandTracking, Warning, TEXT("FSHandPoseArchiveReader: %s is not a supported archive"), *Filename);
+		Close();
+		return false;
+	}
+
+	Chunks.SetNumUninitialized(Header.ChunkCount);
+	Reader->Seek(Header.IndexOffset);
+	Reader->Serialize(Chunks.GetData(), Chunks.Num() * sizeof(FFSHandArchiveChunk));
+
+	for (const FFSHandArchiveChunk& Chunk : Chunks)
+		FrameCount += Chunk.FrameCount;
+
+	return true;
+}
+
+void FFSHandPoseArchiveReader::Close()
+{
+	Reader.Reset();
+	Chunks.Reset();
+	FrameCount = 0;
+}
+
+void FFSHandPoseArchiveReader::FindChunks(const FFSHandArchiveQuery& Query, TArray<int32>& OutChunks) const
+{
+	for (int32 i = 0; i < Chunks.Num(); i++)
+	{
+		if (Query.MatchesChunk(Chunks[i]))
+			OutChunks.Add(i);
+	}
+}
+
+bool FFSHandPoseArchiveReader::ReadChunk(const int32 Chunk, TArray<FFSHandPoseFrame>& OutFrames)
+{
+	if (!Reader.IsValid() || !Chunks.IsValidIndex(Chunk)) return false;
+
+	const FFSHandArchiveChunk& Entry = Chunks[Chunk];
+	const int32 Count = Entry.FrameCount;
+
+	ChunkData.SetNumUninitialized(Entry.Size, EAllowShrinking::No);
+	Reader->Seek(Entry.Offset);
+	Reader->Serialize(ChunkData.GetData(), Entry.Size);
+
+	if (Reader->IsError()) return false;
+
+	Values.SetNumUninitialized(Count * ColumnCount, EAllowShrinking::No);
+
+	const uint8* Data = ChunkData.GetData();
+	const uint8* End = Data + ChunkData.Num();
+
+	for (int32 Column = 0; Column < ColumnCount; Column++)
+	{
+		int32 Value = 0;
+
+		for (int32 i = 0; i < Count; i++)
+		{
+			uint32 Delta;
+			if (!ReadVarint(Data, End, Delta)) return false;
+
+			Value += UnZigZag(Delta);
+			Values[i * ColumnCount + Column] = Value;
+		}
+	}
+
+	OutFrames.SetNumUninitialized(Count, EAllowShrinking::No);
+
+	for (int32 i = 0; i < Count; i++)
+		DequantizeFrame(&Values[i * ColumnCount], Entry.StartTime, OutFrames[i]);
+
+	return true;
+}
+
+int32 FFSHandPoseArchiveReader::Query(const FFSHandArchiveQuery& Query,
+                                      TFunctionRef<void(const FFSHandPoseFrame& Frame,
+                                                        const FFSHandArchiveFeatures& Features)> OnFrame)
+{
+	Candidates.Reset();
+	FindChunks(Query, Candidates);
+
+	int32 MatchCount = 0;
+
+	for (const int32 Chunk : Candidates)
+	{
+		if (!ReadChunk(Chunk, Frames)) continue;
+
+		for (int32 i = 0; i < Frames.Num(); i++)
+		{
+			const FFSHandArchiveFeatures Features = FFSHandArchiveFeatures::Compute(
+				Frames[i], i > 0 ? &Frames[i - 1] : nullptr);
+
+			if (!Query.MatchesFrame(Frames[i], Features)) continue;
+
+			OnFrame(Frames[i], Features);
+			MatchCount++;
+		}
+	}
+
+	return MatchCount;
+}
@@ -0,0 +1,192 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FSHandPoseFilter.h"
+
+namespace
+{
+	// Positions are stored relative to this origin so floats keep their precision far from the world origin.
+	constexpr double MaxOriginDistanceSquared = 1000.0 * 1000.0;
+
+	// One-Euro smoothing factor: r / (r + 1) with r = 2 * PI * Cutoff * DeltaTime
+	FORCEINLINE VectorRegister4Float SmoothingFactor(const VectorRegister4Float& Cutoff,
+	                                                 const VectorRegister4Float& TwoPiDeltaTime)
+	{
+		const VectorRegister4Float R = VectorMultiply(Cutoff, TwoPiDeltaTime);
+		return VectorDivide(R, VectorAdd(R, VectorOne()));
+	}
+}
+
+FFSHandPoseFilter::FFSHandPoseFilter()
+{
+	Reset();
+}
+
+void FFSHandPoseFilter::Reset()
+{
+	for (int32 Lane = 0; Lane < LaneCount; Lane++)
+	{
+		X[Lane] = Y[Lane] = Z[Lane] = 0.0f;
+		VelocityX[Lane] = VelocityY[Lane] = VelocityZ[Lane] = 0.0f;
+		AccelerationX[Lane] = AccelerationY[Lane] = AccelerationZ[Lane] = 0.0f;
+	}
+
+	Rotations.Reset();
+	Origin = FVector::ZeroVector;
+	LastTime = 0.0;
+	bInitialized = false;
+}
+
+void FFSHandPoseFilter::Update(const FVector* RawLocations, const FQuat* RawRotations, const double Time,
+                               const FFSHandFilterSettings& Settings, FVector* OutLocations,
+                               FVector* OutPredictedLocations, FQuat* OutRotations)
+{
+	constexpr int32 Count = FSHandSkeleton::KeypointCount;
+
+	if (bInitialized && FVector::DistSquared(RawLocations[FSHandSkeleton::Palm], Origin) > MaxOriginDistanceSquared)
+		Reset();
+
+	if (!bInitialized)
+		Origin = RawLocations[FSHandSkeleton::Palm];
+
+	// Raw pose in SoA layout
+	alignas(16) float RawX[LaneCount] = {};
+	alignas(16) float RawY[LaneCount] = {};
+	alignas(16) float RawZ[LaneCount] = {};
+	FFSHandQuatBuffer RawQuats;
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		const FVector Local = RawLocations[i] - Origin;
+		RawX[i] = static_cast<float>(Local.X);
+		RawY[i] = static_cast<float>(Local.Y);
+		RawZ[i] = static_cast<float>(Local.Z);
+		RawQuats.SetQuat(i, RawRotations[i]);
+	}
+
+	const float DeltaTime = static_cast<float>(Time - LastTime);
+
+	if (!bInitialized || DeltaTime <= UE_KINDA_SMALL_NUMBER)
+	{
+		if (!bInitialized)
+		{
+			FMemory::Memcpy(X, RawX, sizeof(X));
+			FMemory::Memcpy(Y, RawY, sizeof(Y));
+			FMemory::Memcpy(Z, RawZ, sizeof(Z));
+			Rotations = RawQuats;
+			LastTime = Time;
+			bInitialized = true;
+		}
+	}
+	else
+	{
+		LastTime = Time;
+
+		const VectorRegister4Float TwoPiDeltaTime = VectorSetFloat1(UE_TWO_PI * DeltaTime);
+		const VectorRegister4Float InvDeltaTime = VectorSetFloat1(1.0f / DeltaTime);
+		const VectorRegister4Float DerivativeAlpha =
+			SmoothingFactor(VectorSetFloat1(Settings.DerivativeCutoff), TwoPiDeltaTime);
+		const VectorRegister4Float MinCutoff = VectorSetFloat1(Settings.MinCutoff);
+		const VectorRegister4Float Beta = VectorSetFloat1(Settings.Beta);
+		const VectorRegister4Float MinusOne = VectorSetFloat1(-1.0f);
+
+		for (int32 Lane = 0; Lane < LaneCount; Lane += 4)
+		{
+			const VectorRegister4Float PX = VectorLoadAligned(&X[Lane]);
+			const VectorRegister4Float PY = VectorLoadAligned(&Y[Lane]);
+			const VectorRegister4Float PZ = VectorLoadAligned(&Z[Lane]);
+			const VectorRegister4Float RX = VectorLoadAligned(&RawX[Lane]);
+			const VectorRegister4Float RY = VectorLoadAligned(&RawY[Lane]);
+			const VectorRegister4Float RZ = VectorLoadAligned(&RawZ[Lane]);
+
+			// Filtered velocity
+			const VectorRegister4Float PVX = VectorLoadAligned(&VelocityX[Lane]);
+			const VectorRegister4Float PVY = VectorLoadAligned(&VelocityY[Lane]);
+			const VectorRegister4Float PVZ = VectorLoadAligned(&VelocityZ[Lane]);
+			const VectorRegister4Float VX = VectorMultiplyAdd(
+				DerivativeAlpha, VectorSubtract(VectorMultiply(VectorSubtract(RX, PX), InvDeltaTime), PVX), PVX);
+			const VectorRegister4Float VY = VectorMultiplyAdd(
+				DerivativeAlpha, VectorSubtract(VectorMultiply(VectorSubtract(RY, PY), InvDeltaTime), PVY), PVY);
+			const VectorRegister4Float VZ = VectorMultiplyAdd(
+				DerivativeAlpha, VectorSubtract(VectorMultiply(VectorSubtract(RZ, PZ), InvDeltaTime), PVZ), PVZ);
+
+			// Filtered acceleration, only used by the prediction
+			const VectorRegister4Float PAX = VectorLoadAligned(&AccelerationX[Lane]);
+			const VectorRegister4Float PAY = VectorLoadAligned(&AccelerationY[Lane]);
+			const VectorRegister4Float PAZ = VectorLoadAligned(&AccelerationZ[Lane]);
+			const VectorRegister4Float AX = VectorMultiplyAdd(
+				DerivativeAlpha, VectorSubtract(VectorMultiply(VectorSubtract(VX, PVX), InvDeltaTime), PAX), PAX);
+			const VectorRegister4Float AY = VectorMultiplyAdd(
+				DerivativeAlpha, VectorSubtract(VectorMultiply(VectorSubtract(VY, PVY), InvDeltaTime), PAY), PAY);
+			const VectorRegister4Float AZ = VectorMultiplyAdd(
+				DerivativeAlpha, VectorSubtract(VectorMultiply(VectorSubtract(VZ, PVZ), InvDeltaTime), PAZ), PAZ);
+
+			// Adaptive cutoff: fast joints are less filtered
+			VectorRegister4Float SpeedSquared = VectorMultiply(VX, VX);
+			SpeedSquared = VectorMultiplyAdd(VY, VY, SpeedSquared);
+			SpeedSquared = VectorMultiplyAdd(VZ, VZ, SpeedSquared);
+			const VectorRegister4Float Cutoff = VectorMultiplyAdd(Beta, VectorSqrt(SpeedSquared), MinCutoff);
+			const VectorRegister4Float Alpha = SmoothingFactor(Cutoff, TwoPiDeltaTime);
+
+			VectorStoreAligned(VectorMultiplyAdd(Alpha, VectorSubtract(RX, PX), PX), &X[Lane]);
+			VectorStoreAligned(VectorMultiplyAdd(Alpha, VectorSubtract(RY, PY), PY), &Y[Lane]);
+			VectorStoreAligned(VectorMultiplyAdd(Alpha, VectorSubtract(RZ, PZ), PZ), &Z[Lane]);
+			VectorStoreAligned(VX, &VelocityX[Lane]);
+			VectorStoreAligned(VY, &VelocityY[Lane]);
+			VectorStoreAligned(VZ, &VelocityZ[Lane]);
+			VectorStoreAligned(AX, &AccelerationX[Lane]);
+			VectorStoreAligned(AY, &AccelerationY[Lane]);
+			VectorStoreAligned(AZ, &AccelerationZ[Lane]);
+
+			// Rotations: normalized lerp on the shortest path with the joint smoothing factor
+			const VectorRegister4Float QX = VectorLoadAligned(&Rotations.X[Lane]);
+			const VectorRegister4Float QY = VectorLoadAligned(&Rotations.Y[Lane]);
+			const VectorRegister4Float QZ = VectorLoadAligned(&Rotations.Z[Lane]);
+			const VectorRegister4Float QW = VectorLoadAligned(&Rotations.W[Lane]);
+			VectorRegister4Float TX = VectorLoadAligned(&RawQuats.X[Lane]);
+			VectorRegister4Float TY = VectorLoadAligned(&RawQuats.Y[Lane]);
+			VectorRegister4Float TZ = VectorLoadAligned(&RawQuats.Z[Lane]);
+			VectorRegister4Float TW = VectorLoadAligned(&RawQuats.W[Lane]);
+
+			VectorRegister4Float Dot = VectorMultiply(QX, TX);
+			Dot = VectorMultiplyAdd(QY, TY, Dot);
+			Dot = VectorMultiplyAdd(QZ, TZ, Dot);
+			Dot = VectorMultiplyAdd(QW, TW, Dot);
+			const VectorRegister4Float Sign = VectorSelect(VectorCompareLT(Dot, VectorZero()), MinusOne, VectorOne());
+			TX = VectorMultiply(TX, Sign);
+			TY = VectorMultiply(TY, Sign);
+			TZ = VectorMultiply(TZ, Sign);
+			TW = VectorMultiply(TW, Sign);
+
+			const VectorRegister4Float NX = VectorMultiplyAdd(Alpha, VectorSubtract(TX, QX), QX);
+			const VectorRegister4Float NY = VectorMultiplyAdd(Alpha, VectorSubtract(TY, QY), QY);
+			const VectorRegister4Float NZ = VectorMultiplyAdd(Alpha, VectorSubtract(TZ, QZ), QZ);
+			const VectorRegister4Float NW = VectorMultiplyAdd(Alpha, VectorSubtract(TW, QW), QW);
+
+			VectorRegister4Float LengthSquared = VectorMultiply(NX, NX);
+			LengthSquared = VectorMultiplyAdd(NY, NY, LengthSquared);
+			LengthSquared = VectorMultiplyAdd(NZ, NZ, LengthSquared);
+			LengthSquared = VectorMultiplyAdd(NW, NW, LengthSquared);
+			const VectorRegister4Float InvLength = VectorReciprocalSqrt(LengthSquared);
+
+			VectorStoreAligned(VectorMultiply(NX, InvLength), &Rotations.X[Lane]);
+			VectorStoreAligned(VectorMultiply(NY, InvLength), &Rotations.Y[Lane]);
+			VectorStoreAligned(VectorMultiply(NZ, InvLength), &Rotations.Z[Lane]);
+			VectorStoreAligned(VectorMultiply(NW, InvLength), &Rotations.W[Lane]);
+		}
+	}
+
+	// Outputs, the prediction extrapolates the filtered state.
+	const float PredictionTime = FMath::Max(Settings.PredictionTime, 0.0f);
+	const float HalfPredictionTimeSquared = Settings.bPredictAcceleration ? 0.5f * FMath::Square(PredictionTime) : 0.0f;
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		const FVector Filtered = Origin + FVector(X[i], Y[i], Z[i]);
+		const FVector Velocity(VelocityX[i], VelocityY[i], VelocityZ[i]);
+		const FVector Acceleration(AccelerationX[i], AccelerationY[i], AccelerationZ[i]);
+
+		OutLocations[i] = Filtered;
+		OutPredictedLocations[i] = Filtered + Velocity * PredictionTime + Acceleration * HalfPredictionTimeSquared;
+		OutRotations[i] = Rotations.GetQuat(i);
+	}
+}
@@ -0,0 +1,354 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FSHandPoseGenerator.h"
+
+namespace
+{
+	constexpr int32 MaxSegments = 4;
+
+	// Left hand proportions (cm), palm down: X forward, Y toward the thumb, Z on the back of the hand.
+	// Right hands mirror Y and the finger yaws.
+	// Start of each finger relative to the wrist.
+	constexpr float FingerBases[FSHandSkeleton::FingerCount][3] =
+	{
+		{1.5f, 2.0f, -1.0f},
+		{1.0f, 1.2f, 0.0f},
+		{1.0f, 0.0f, 0.0f},
+		{1.0f, -1.1f, 0.0f},
+		{0.8f, -2.1f, -0.2f}
+	};
+
+	// Spread of each finger around Z (degrees).
+	constexpr float FingerYaws[FSHandSkeleton::FingerCount] = {50.0f, 8.0f, 0.0f, -7.0f, -15.0f};
+
+	// Length of the bone after each joint, from the metacarpal to the distal.
+	constexpr float SegmentLengths[FSHandSkeleton::FingerCount][MaxSegments] =
+	{
+		{4.0f, 3.2f, 2.5f, 0.0f},
+		{6.5f, 4.0f, 2.4f, 2.0f},
+		{6.3f, 4.5f, 2.8f, 2.1f},
+		{5.8f, 4.2f, 2.7f, 2.0f},
+		{5.3f, 3.3f, 2.0f, 1.9f}
+	};
+
+	// Bend of each joint for a full curl (degrees).
+	constexpr float MaxBends[FSHandSkeleton::FingerCount][MaxSegments] =
+	{
+		{15.0f, 45.0f, 70.0f, 0.0f},
+		{5.0f, 80.0f, 100.0f, 70.0f},
+		{5.0f, 85.0f, 105.0f, 70.0f},
+		{5.0f, 85.0f, 100.0f, 65.0f},
+		{10.0f, 85.0f, 95.0f, 65.0f}
+	};
+
+	// Palm keypoint, center of the middle metacarpal.
+	constexpr float PalmOffset = 4.15f;
+
+	// Curl of the thumb and index when pinching, their tips are then pulled together.
+	constexpr float ThumbPinchCurl = 0.35f;
+	constexpr float IndexPinchCurl = 0.45f;
+
+	// Frequencies are integer multiples of this step so every motion loops over LoopPeriod.
+	constexpr float FrequencyStep = UE_TWO_PI / FFSHandPoseGenerator::LoopPeriod;
+
+	struct FQuatLanes
+	{
+		VectorRegister4Float X;
+		VectorRegister4Float Y;
+		VectorRegister4Float Z;
+		VectorRegister4Float W;
+	};
+
+	// Same convention as FQuat::operator*, B is applied first.
+	FORCEINLINE FQuatLanes Multiply(const FQuatLanes& A, const FQuatLanes& B)
+	{
+		FQuatLanes Result;
+		Result.X = VectorMultiplyAdd(A.W, B.X, VectorMultiplyAdd(A.X, B.W, VectorNegateMultiplyAdd(A.Z, B.Y, VectorMultiply(A.Y, B.Z))));
+		Result.Y = VectorMultiplyAdd(A.W, B.Y, VectorMultiplyAdd(A.Y, B.W, VectorNegateMultiplyAdd(A.X, B.Z, VectorMultiply(A.Z, B.X))));
+		Result.Z = VectorMultiplyAdd(A.W, B.Z, VectorMultiplyAdd(A.Z, B.W, VectorNegateMultiplyAdd(A.Y, B.X, VectorMultiply(A.X, B.Y))));
+		Result.W = VectorNegateMultiplyAdd(A.Z, B.Z, VectorNegateMultiplyAdd(A.Y, B.Y, VectorNegateMultiplyAdd(A.X, B.X, VectorMultiply(A.W, B.W))));
+		return Result;
+	}
+
+	// V + 2W(Q x V) + 2Q x (Q x V)
+	FORCEINLINE void Rotate(const FQuatLanes& Q, VectorRegister4Float& X, VectorRegister4Float& Y, VectorRegister4Float& Z)
+	{
+		const VectorRegister4Float Two = VectorSetFloat1(2.0f);
+		const VectorRegister4Float TX = VectorMultiply(Two, VectorNegateMultiplyAdd(Q.Z, Y, VectorMultiply(Q.Y, Z)));
+		const VectorRegister4Float TY = VectorMultiply(Two, VectorNegateMultiplyAdd(Q.X, Z, VectorMultiply(Q.Z, X)));
+		const VectorRegister4Float TZ = VectorMultiply(Two, VectorNegateMultiplyAdd(Q.Y, X, VectorMultiply(Q.X, Y)));
+
+		X = VectorAdd(VectorMultiplyAdd(Q.W, TX, X), VectorNegateMultiplyAdd(Q.Z, TY, VectorMultiply(Q.Y, TZ)));
+		Y = VectorAdd(VectorMultiplyAdd(Q.W, TY, Y), VectorNegateMultiplyAdd(Q.X, TZ, VectorMultiply(Q.Z, TX)));
+		Z = VectorAdd(VectorMultiplyAdd(Q.W, TZ, Z), VectorNegateMultiplyAdd(Q.Y, TX, VectorMultiply(Q.X, TY)));
+	}
+
+	// Yaw around Z then pitch around Y, as FQuat(Z, Yaw) * FQuat(Y, Pitch).
+	FORCEINLINE FQuatLanes MakeYawPitch(const VectorRegister4Float& SinHalfYaw, const VectorRegister4Float& CosHalfYaw,
+	                                    const VectorRegister4Float& SinHalfPitch, const VectorRegister4Float& CosHalfPitch)
+	{
+		FQuatLanes Result;
+		Result.X = VectorNegate(VectorMultiply(SinHalfYaw, SinHalfPitch));
+		Result.Y = VectorMultiply(CosHalfYaw, SinHalfPitch);
+		Result.Z = VectorMultiply(SinHalfYaw, CosHalfPitch);
+		Result.W = VectorMultiply(CosHalfYaw, CosHalfPitch);
+		return Result;
+	}
+
+	FORCEINLINE VectorRegister4Float Wave(const VectorRegister4Float& Time, const VectorRegister4Float& Frequency,
+	                                      const VectorRegister4Float& Phase)
+	{
+		return VectorSin(VectorMultiplyAdd(Time, Frequency, Phase));
+	}
+
+	FORCEINLINE VectorRegister4Float Lerp(const VectorRegister4Float& A, const VectorRegister4Float& B,
+	                                      const VectorRegister4Float& Alpha)
+	{
+		return VectorMultiplyAdd(VectorSubtract(B, A), Alpha, A);
+	}
+
+	// Murmur3 finalizer, uniform bits from a hand and a second.
+	FORCEINLINE uint32 MixBits(uint32 Value)
+	{
+		Value ^= Value >> 16;
+		Value *= 0x85EBCA6Bu;
+		Value ^= Value >> 13;
+		Value *= 0xC2B2AE35u;
+		Value ^= Value >> 16;
+		return Value;
+	}
+}
+
+FFSHandPoseGenerator::FFSHandPoseGenerator(const int32 InHandCount, const int32 Seed,
+                                           const FFSHandGeneratorSettings& InSettings)
+	: Settings(InSettings)
+	, HandCount(FMath::Max(InHandCount, 0))
+	, PaddedCount(Align(HandCount, 4))
+{
+	FRandomStream Random(Seed);
+	DropoutSeed = static_cast<uint32>(Random.GetUnsignedInt());
+
+	for (FLanes* Lanes : {&OriginX, &OriginY, &OriginZ, &Sides, &Scales, &CurlFrequencies, &PinchFrequencies,
+	                      &PinchPhases, &WristFrequencies, &WristPhases})
+		Lanes->SetNumZeroed(PaddedCount);
+
+	for (FLanes& Lanes : CurlPhases)
+		Lanes.SetNumZeroed(PaddedCount);
+
+	for (FLanes* Lanes : {&PositionX, &PositionY, &PositionZ, &RotationX, &RotationY, &RotationZ, &RotationW})
+		Lanes->SetNumZeroed(FSHandSkeleton::KeypointCount * PaddedCount);
+
+	Tracked.Init(true, HandCount);
+
+	// Pairs of hands on a square grid, padding lanes are generated but never read.
+	const int32 Columns = FMath::Max(FMath::CeilToInt32(FMath::Sqrt(static_cast<float>(HandCount) * 0.5f)), 1);
+
+	for (int32 Hand = 0; Hand < PaddedCount; Hand++)
+	{
+		const int32 Pair = Hand / 2;
+		const bool bLeft = Hand % 2 == 0;
+
+		OriginX[Hand] = (Pair / Columns) * Settings.Spacing;
+		OriginY[Hand] = (Pair % Columns) * Settings.Spacing + (bLeft ? -15.0f : 15.0f);
+		OriginZ[Hand] = 100.0f;
+		// The tables describe a palm down left hand, right hands are mirrored on Y.
+		Sides[Hand] = bLeft ? 1.0f : -1.0f;
+		Scales[Hand] = Random.FRandRange(Settings.MinHandScale, Settings.MaxHandScale);
+		CurlFrequencies[Hand] = Random.RandRange(24, 64) * FrequencyStep;
+		PinchFrequencies[Hand] = Random.RandRange(8, 24) * FrequencyStep;
+		PinchPhases[Hand] = Random.FRandRange(0.0f, UE_TWO_PI);
+		WristFrequencies[Hand] = Random.RandRange(4, 16) * FrequencyStep;
+		WristPhases[Hand] = Random.FRandRange(0.0f, UE_TWO_PI);
+
+		for (FLanes& Lanes : CurlPhases)
+			Lanes[Hand] = Random.FRandRange(0.0f, UE_TWO_PI);
+	}
+}
+
+void FFSHandPoseGenerator::Generate(const double Time)
+{
+	// Float precision is kept by looping the time, every frequency is a multiple of the loop frequency.
+	const VectorRegister4Float T = VectorSetFloat1(static_cast<float>(FMath::Fmod(Time, static_cast<double>(LoopPeriod))));
+	const VectorRegister4Float Zero = VectorZero();
+	const VectorRegister4Float One = VectorOne();
+	const VectorRegister4Float Half = VectorSetFloat1(0.5f);
+	const VectorRegister4Float Step = VectorSetFloat1(FrequencyStep);
+	const VectorRegister4Float WristAmplitude = VectorSetFloat1(Settings.WristAmplitude);
+	const VectorRegister4Float HalfWristAngle = VectorSetFloat1(FMath::DegreesToRadians(Settings.WristAngle) * 0.5f);
+
+	for (int32 Base = 0; Base < PaddedCount; Base += 4)
+	{
+		const VectorRegister4Float Side = VectorLoadAligned(&Sides[Base]);
+		const VectorRegister4Float Scale = VectorLoadAligned(&Scales[Base]);
+
+		// Curls, the thumb and index are pulled to the pinch pose.
+		const VectorRegister4Float CurlFrequency = VectorLoadAligned(&CurlFrequencies[Base]);
+		VectorRegister4Float Curls[FSHandSkeleton::FingerCount];
+
+		for (int32 Finger = 0; Finger < FSHandSkeleton::FingerCount; Finger++)
+			Curls[Finger] = VectorMultiplyAdd(Half, Wave(T, CurlFrequency, VectorLoadAligned(&CurlPhases[Finger][Base])), Half);
+
+		// Pinches hold for about a sixth of their period.
+		VectorRegister4Float Pinch = Wave(T, VectorLoadAligned(&PinchFrequencies[Base]), VectorLoadAligned(&PinchPhases[Base]));
+		Pinch = VectorMin(VectorMax(VectorSubtract(VectorAdd(Pinch, Pinch), One), Zero), One);
+		Curls[0] = Lerp(Curls[0], VectorSetFloat1(ThumbPinchCurl), Pinch);
+		Curls[1] = Lerp(Curls[1], VectorSetFloat1(IndexPinchCurl), Pinch);
+
+		// Wrist, each axis at its own multiple of the wrist frequency.
+		const VectorRegister4Float WristFrequency = VectorLoadAligned(&WristFrequencies[Base]);
+		const VectorRegister4Float WristPhase = VectorLoadAligned(&WristPhases[Base]);
+		const VectorRegister4Float WristX = VectorMultiplyAdd(WristAmplitude, Wave(T, WristFrequency, WristPhase),
+		                                                      VectorLoadAligned(&OriginX[Base]));
+		const VectorRegister4Float WristY = VectorMultiplyAdd(WristAmplitude, Wave(T, VectorAdd(WristFrequency, Step), WristPhase),
+		                                                      VectorLoadAligned(&OriginY[Base]));
+		const VectorRegister4Float WristZ = VectorMultiplyAdd(WristAmplitude, Wave(T, VectorAdd(WristFrequency, VectorAdd(Step, Step)), WristPhase),
+		                                                      VectorLoadAligned(&OriginZ[Base]));
+
+		VectorRegister4Float HalfYaw = VectorMultiply(HalfWristAngle, Wave(T, VectorAdd(WristFrequency, VectorMultiply(Step, VectorSetFloat1(3.0f))), WristPhase));
+		VectorRegister4Float HalfPitch = VectorMultiply(VectorMultiply(HalfWristAngle, Half), Wave(T, VectorAdd(WristFrequency, VectorMultiply(Step, VectorSetFloat1(5.0f))), WristPhase));
+		VectorRegister4Float SinHalfYaw, CosHalfYaw, SinHalfPitch, CosHalfPitch;
+		VectorSinCos(&SinHalfYaw, &CosHalfYaw, &HalfYaw);
+		VectorSinCos(&SinHalfPitch, &CosHalfPitch, &HalfPitch);
+		const FQuatLanes Wrist = MakeYawPitch(SinHalfYaw, CosHalfYaw, SinHalfPitch, CosHalfPitch);
+
+		auto Store = [this, Base](const int32 Joint, const VectorRegister4Float& X, const VectorRegister4Float& Y,
+		                          const VectorRegister4Float& Z, const FQuatLanes& Rotation)
+		{
+			const int32 Lane = GetLane(Joint, Base);
+			VectorStoreAligned(X, &PositionX[Lane]);
+			VectorStoreAligned(Y, &PositionY[Lane]);
+			VectorStoreAligned(Z, &PositionZ[Lane]);
+			VectorStoreAligned(Rotation.X, &RotationX[Lane]);
+			VectorStoreAligned(Rotation.Y, &RotationY[Lane]);
+			VectorStoreAligned(Rotation.Z, &RotationZ[Lane]);
+			VectorStoreAligned(Rotation.W, &RotationW[Lane]);
+		};
+
+		// Local positions are scaled, mirrored by the side, rotated by the wrist then moved to it.
+		auto StoreLocal = [&](const int32 Joint, VectorRegister4Float X, VectorRegister4Float Y, VectorRegister4Float Z,
+		                      const FQuatLanes& Rotation)
+		{
+			Rotate(Wrist, X, Y, Z);
+			Store(Joint, VectorAdd(X, WristX), VectorAdd(Y, WristY), VectorAdd(Z, WristZ), Rotation);
+		};
+
+		Store(FSHandSkeleton::Wrist, WristX, WristY, WristZ, Wrist);
+		StoreLocal(FSHandSkeleton::Palm, VectorMultiply(VectorSetFloat1(PalmOffset), Scale), Zero, Zero, Wrist);
+
+		for (int32 Finger = 0; Finger < FSHandSkeleton::FingerCount; Finger++)
+		{
+			const int32 Start = FSHandSkeleton::FingerStartIndices[Finger];
+			const int32 Tip = FSHandSkeleton::FingerTipIndices[Finger];
+
+			// Mirroring the hand negates the yaw.
+			const float HalfYawAngle = FMath::DegreesToRadians(FingerYaws[Finger]) * 0.5f;
+			const VectorRegister4Float SinHalfFingerYaw = VectorMultiply(VectorSetFloat1(FMath::Sin(HalfYawAngle)), Side);
+			const VectorRegister4Float CosHalfFingerYaw = VectorSetFloat1(FMath::Cos(HalfYawAngle));
+			const VectorRegister4Float SinYaw = VectorMultiply(VectorSetFloat1(FMath::Sin(HalfYawAngle * 2.0f)), Side);
+			const VectorRegister4Float CosYaw = VectorSetFloat1(FMath::Cos(HalfYawAngle * 2.0f));
+
+			VectorRegister4Float X = VectorMultiply(VectorSetFloat1(FingerBases[Finger][0]), Scale);
+			VectorRegister4Float Y = VectorMultiply(VectorMultiply(VectorSetFloat1(FingerBases[Finger][1]), Scale), Side);
+			VectorRegister4Float Z = VectorMultiply(VectorSetFloat1(FingerBases[Finger][2]), Scale);
+			VectorRegister4Float Bend = Zero;
+
+			for (int32 Joint = Start; Joint <= Tip; Joint++)
+			{
+				const int32 Segment = Joint - Start;
+
+				// The tip keeps the direction of the distal.
+				if (Joint < Tip)
+					Bend = VectorMultiplyAdd(VectorSetFloat1(FMath::DegreesToRadians(MaxBends[Finger][Segment])), Curls[Finger], Bend);
+
+				VectorRegister4Float HalfBend = VectorMultiply(Bend, Half);
+				VectorRegister4Float SinHalfBend, CosHalfBend;
+				VectorSinCos(&SinHalfBend, &CosHalfBend, &HalfBend);
+
+				const FQuatLanes Local = MakeYawPitch(SinHalfFingerYaw, CosHalfFingerYaw, SinHalfBend, CosHalfBend);
+				StoreLocal(Joint, X, Y, Z, Multiply(Wrist, Local));
+
+				if (Joint == Tip) break;
+
+				// Bone direction, FQuat(Z, Yaw) * FQuat(Y, Bend) applied to X.
+				VectorRegister4Float SinBend, CosBend;
+				VectorSinCos(&SinBend, &CosBend, &Bend);
+				const VectorRegister4Float Length = VectorMultiply(VectorSetFloat1(SegmentLengths[Finger][Segment]), Scale);
+				X = VectorMultiplyAdd(Length, VectorMultiply(CosYaw, CosBend), X);
+				Y = VectorMultiplyAdd(Length, VectorMultiply(SinYaw, CosBend), Y);
+				Z = VectorNegateMultiplyAdd(Length, SinBend, Z);
+			}
+		}
+
+		// Pinch, the thumb and index tips meet halfway and drag their distal joints.
+		const int32 ThumbTip = FSHandSkeleton::ThumbTip;
+		const int32 IndexTip = FSHandSkeleton::FingerTipIndices[1];
+		FLanes* Positions[3] = {&PositionX, &PositionY, &PositionZ};
+
+		for (FLanes* Lanes : Positions)
+		{
+			float* ThumbTipLane = &(*Lanes)[GetLane(ThumbTip, Base)];
+			float* IndexTipLane = &(*Lanes)[GetLane(IndexTip, Base)];
+			float* ThumbDistalLane = &(*Lanes)[GetLane(ThumbTip - 1, Base)];
+			float* IndexDistalLane = &(*Lanes)[GetLane(IndexTip - 1, Base)];
+
+			const VectorRegister4Float Thumb = VectorLoadAligned(ThumbTipLane);
+			const VectorRegister4Float Index = VectorLoadAligned(IndexTipLane);
+			const VectorRegister4Float Middle = VectorMultiply(VectorAdd(Thumb, Index), Half);
+			const VectorRegister4Float ThumbDelta = VectorMultiply(VectorSubtract(Middle, Thumb), Pinch);
+			const VectorRegister4Float IndexDelta = VectorMultiply(VectorSubtract(Middle, Index), Pinch);
+
+			VectorStoreAligned(VectorAdd(Thumb, ThumbDelta), ThumbTipLane);
+			VectorStoreAligned(VectorAdd(Index, IndexDelta), IndexTipLane);
+			VectorStoreAligned(VectorMultiplyAdd(ThumbDelta, Half, VectorLoadAligned(ThumbDistalLane)), ThumbDistalLane);
+			VectorStoreAligned(VectorMultiplyAdd(IndexDelta, Half, VectorLoadAligned(IndexDistalLane)), IndexDistalLane);
+		}
+	}
+
+	// Tracking losses, drawn once per hand and per second.
+	const int64 Second = FMath::FloorToInt64(Time);
+	const float SecondFraction = static_cast<float>(Time - Second);
+
+	for (int32 Hand = 0; Hand < HandCount; Hand++)
+	{
+		const uint32 Bits = MixBits(DropoutSeed ^ MixBits(static_cast<uint32>(Hand) ^ MixBits(static_cast<uint32>(Second))));
+		const bool bLost = Bits * (1.0f / 4294967296.0f) < Settings.DropoutRate && SecondFraction < Settings.DropoutDuration;
+		Tracked[Hand] = !bLost;
+	}
+}
+
+void FFSHandPoseGenerator::GetHandData(const int32 Hand, FXRMotionControllerData& OutData) const
+{
+	check(Hand >= 0 && Hand < HandCount);
+
+	constexpr int32 Count = FSHandSkeleton::KeypointCount;
+	const bool bTracked = Tracked[Hand];
+
+	OutData.bValid = bTracked;
+	OutData.HandIndex = Hand % 2 == 0 ? EControllerHand::Left : EControllerHand::Right;
+	OutData.DeviceVisualType = EXRVisualType::Hand;
+	OutData.TrackingStatus = bTracked ? ETrackingStatus::Tracked : ETrackingStatus::NotTracked;
+	OutData.HandKeyPositions.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutData.HandKeyRotations.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutData.HandKeyRadii.SetNumUninitialized(Count, EAllowShrinking::No);
+
+	for (int32 Joint = 0; Joint < Count; Joint++)
+	{
+		const int32 Lane = GetLane(Joint, Hand);
+		OutData.HandKeyPositions[Joint] = FVector(PositionX[Lane], PositionY[Lane], PositionZ[Lane]);
+		OutData.HandKeyRotations[Joint] = FQuat(RotationX[Lane], RotationY[Lane], RotationZ[Lane], RotationW[Lane]);
+
+		// Bones get thinner toward the tips.
+		const int32 Finger = FSHandSkeleton::FingerIndices[Joint];
+		const float Radius = Finger == INDEX_NONE
+			                     ? 1.5f
+			                     : 1.0f - 0.1f * (Joint - FSHandSkeleton::FingerStartIndices[Finger]);
+		OutData.HandKeyRadii[Joint] = Radius * Scales[Hand];
+	}
+
+	OutData.PalmPosition = OutData.HandKeyPositions[FSHandSkeleton::Palm];
+	OutData.PalmRotation = OutData.HandKeyRotations[FSHandSkeleton::Palm];
+	OutData.GripPosition = OutData.PalmPosition;
+	OutData.GripRotation = OutData.PalmRotation;
+	OutData.AimPosition = OutData.PalmPosition;
+	OutData.AimRotation = OutData.PalmRotation;
+}
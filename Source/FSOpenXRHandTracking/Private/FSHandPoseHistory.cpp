@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FSHandPoseHistory.h"
+
+FFSHandPoseHistory::FFSHandPoseHistory()
+{
+	Reset();
+}
+
+void FFSHandPoseHistory::Reset()
+{
+	Head = Capacity - 1;
+	Count = 0;
+	PushCount = 0;
+}
+
+bool FFSHandPoseHistory::Push(const double Time, const FVector* Locations, const FQuat& PalmRotation)
+{
+	const FSample* Previous = Count > 0 ? &GetSample(0) : nullptr;
+
+	if (Previous != nullptr && Time <= Previous->Time)
+		return false;
+
+	const int32 NewHead = (Head + 1) % Capacity;
+	FSample& Sample = Samples[NewHead];
+	const float InvDeltaTime = Previous != nullptr ? static_cast<float>(1.0 / (Time - Previous->Time)) : 0.0f;
+
+	for (int32 i = 0; i < FSHandSkeleton::KeypointCount; i++)
+	{
+		Sample.Velocities[i] = Previous != nullptr
+			                       ? FVector3f(Locations[i] - Previous->Locations[i]) * InvDeltaTime
+			                       : FVector3f::ZeroVector;
+		Sample.Locations[i] = Locations[i];
+	}
+
+	Sample.Time = Time;
+	Sample.PalmRotation = PalmRotation;
+
+	Head = NewHead;
+	Count = FMath::Min(Count + 1, Capacity);
+	PushCount++;
+	return true;
+}
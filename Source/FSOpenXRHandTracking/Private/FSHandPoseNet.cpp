@@ -0,0 +1,434 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FSHandPoseNet.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+
+namespace
+{
+	constexpr float DefaultRadii[FSHandSkeleton::KeypointCount] =
+	{
+		1.5f, 1.5f, // Palm, Wrist
+		1.4f, 1.1f, 0.9f, 0.8f, // Thumb
+		1.1f, 1.0f, 0.8f, 0.7f, 0.6f, // Index
+		1.1f, 1.0f, 0.8f, 0.7f, 0.6f, // Middle
+		1.1f, 0.9f, 0.75f, 0.65f, 0.55f, // Ring
+		1.1f, 0.8f, 0.65f, 0.55f, 0.5f // Little
+	};
+
+	constexpr uint32 RotationComponentBits = 10;
+	constexpr uint32 RotationComponentMax = (1 << RotationComponentBits) - 1;
+
+	// Zero flag, then the zigzag encoded difference with a 5 bits width prefix.
+	void WriteValue(FBitWriter& Writer, const int32 Value, const int32 Base)
+	{
+		const int32 Delta = static_cast<int32>(static_cast<uint32>(Value) - static_cast<uint32>(Base));
+		uint32 ZigZag = (static_cast<uint32>(Delta) << 1) ^ static_cast<uint32>(Delta >> 31);
+
+		Writer.WriteBit(ZigZag != 0 ? 1 : 0);
+		if (ZigZag == 0) return;
+
+		const uint32 BitCount = FMath::FloorLog2(ZigZag) + 1;
+		uint32 Header = BitCount - 1;
+		Writer.SerializeBits(&Header, 5);
+		Writer.SerializeBits(&ZigZag, BitCount);
+	}
+
+	int32 ReadValue(FBitReader& Reader, const int32 Base)
+	{
+		if (Reader.ReadBit() == 0) return Base;
+
+		uint32 Header = 0;
+		Reader.SerializeBits(&Header, 5);
+
+		uint32 ZigZag = 0;
+		Reader.SerializeBits(&ZigZag, Header + 1);
+
+		const uint32 Delta = (ZigZag >> 1) ^ (0u - (ZigZag & 1));
+		return static_cast<int32>(static_cast<uint32>(Base) + Delta);
+	}
+
+	// Components are delta encoded when the largest component didn't change, otherwise the packed value is sent.
+	void WriteRotation(FBitWriter& Writer, const uint32 Value, const uint32* Base)
+	{
+		if (Base != nullptr && (Value >> 30) == (*Base >> 30))
+		{
+			Writer.WriteBit(1);
+
+			for (int32 Shift = 20; Shift >= 0; Shift -= RotationComponentBits)
+			{
+				WriteValue(Writer, (Value >> Shift) & RotationComponentMax, (*Base >> Shift) & RotationComponentMax);
+			}
+		}
+		else
+		{
+			Writer.WriteBit(0);
+			uint32 Packed = Value;
+			Writer.SerializeBits(&Packed, 32);
+		}
+	}
+
+	uint32 ReadRotation(FBitReader& Reader, const uint32* Base)
+	{
+		if (Reader.ReadBit() != 0)
+		{
+			if (Base == nullptr)
+			{
+				Reader.SetError();
+				return 0;
+			}
+
+			uint32 Packed = *Base & 0xC0000000;
+
+			for (int32 Shift = 20; Shift >= 0; Shift -= RotationComponentBits)
+			{
+				const int32 Component = ReadValue(Reader, (*Base >> Shift) & RotationComponentMax);
+				Packed |= (static_cast<uint32>(Component) & RotationComponentMax) << Shift;
+			}
+
+			return Packed;
+		}
+
+		uint32 Packed = 0;
+		Reader.SerializeBits(&Packed, 32);
+		return Packed;
+	}
+
+	int32 QuantizePosition(const double Value, const double Max)
+	{
+		return FMath::RoundToInt32(FMath::Clamp(Value * FFSQuantizedHandPose::PositionScale, -Max, Max));
+	}
+}
+
+void FFSQuantizedHandPose::Quantize(const FXRMotionControllerData& InData)
+{
+	bValid = InData.bValid && InData.HandKeyPositions.Num() == FSHandSkeleton::KeypointCount &&
+		InData.HandKeyRotations.Num() == FSHandSkeleton::KeypointCount;
+
+	if (!bValid) return;
+
+	const FVector PalmLocation = InData.HandKeyPositions[FSHandSkeleton::Palm];
+	const FQuat PalmQuat = InData.HandKeyRotations[FSHandSkeleton::Palm].GetNormalized();
+	const FQuat InversePalmQuat = PalmQuat.Inverse();
+
+	for (int32 Axis = 0; Axis < 3; Axis++)
+		PalmPosition[Axis] = QuantizePosition(PalmLocation[Axis], MAX_int32);
+
+	PalmRotation = PackRotation(PalmQuat);
+
+	for (int32 i = 0; i < FSHandSkeleton::KeypointCount; i++)
+	{
+		const FVector Local = InversePalmQuat.RotateVector(InData.HandKeyPositions[i] - PalmLocation);
+
+		for (int32 Axis = 0; Axis < 3; Axis++)
+			Positions[i][Axis] = static_cast<int16>(QuantizePosition(Local[Axis], MAX_int16));
+
+		Rotations[i] = PackRotation(InversePalmQuat * InData.HandKeyRotations[i]);
+	}
+}
+
+void FFSQuantizedHandPose::Dequantize(FVector* OutPositions, FQuat* OutRotations) const
+{
+	const FVector PalmLocation = FVector(PalmPosition[0], PalmPosition[1], PalmPosition[2]) / PositionScale;
+	const FQuat PalmQuat = UnpackRotation(PalmRotation);
+
+	for (int32 i = 0; i < FSHandSkeleton::KeypointCount; i++)
+	{
+		const FVector Local = FVector(Positions[i][0], Positions[i][1], Positions[i][2]) / PositionScale;
+		OutPositions[i] = PalmLocation + PalmQuat.RotateVector(Local);
+		OutRotations[i] = PalmQuat * UnpackRotation(Rotations[i]);
+	}
+}
+
+uint32 FFSQuantizedHandPose::PackRotation(const FQuat& Rotation)
+{
+	const FQuat Quat = Rotation.GetNormalized();
+	double Components[4] = {Quat.X, Quat.Y, Quat.Z, Quat.W};
+
+	uint32 Largest = 0;
+
+	for (uint32 i = 1; i < 4; i++)
+	{
+		if (FMath::Abs(Components[i]) > FMath::Abs(Components[Largest]))
+			Largest = i;
+	}
+
+	// q and -q are the same rotation, keep the largest component positive so it can be rebuilt.
+	const double Sign = Components[Largest] < 0.0 ? -1.0 : 1.0;
+
+	uint32 Packed = Largest << 30;
+	int32 Shift = 20;
+
+	for (uint32 i = 0; i < 4; i++)
+	{
+		if (i == Largest) continue;
+
+		const double Normalized = FMath::Clamp(Components[i] * Sign / UE_DOUBLE_INV_SQRT_2 * 0.5 + 0.5, 0.0, 1.0);
+		Packed |= static_cast<uint32>(FMath::RoundToInt32(Normalized * RotationComponentMax)) << Shift;
+		Shift -= RotationComponentBits;
+	}
+
+	return Packed;
+}
+
+FQuat FFSQuantizedHandPose::UnpackRotation(const uint32 Packed)
+{
+	const uint32 Largest = Packed >> 30;
+	double Components[4];
+	double SumSquared = 0.0;
+	int32 Shift = 20;
+
+	for (uint32 i = 0; i < 4; i++)
+	{
+		if (i == Largest) continue;
+
+		const double Normalized = static_cast<double>((Packed >> Shift) & RotationComponentMax) / RotationComponentMax;
+		Components[i] = (Normalized - 0.5) * 2.0 * UE_DOUBLE_INV_SQRT_2;
+		SumSquared += Components[i] * Components[i];
+		Shift -= RotationComponentBits;
+	}
+
+	Components[Largest] = FMath::Sqrt(FMath::Max(0.0, 1.0 - SumSquared));
+	return FQuat(Components[0], Components[1], Components[2], Components[3]).GetNormalized();
+}
+
+bool FFSNetHandPose::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << Sequence;
+	Ar << BaselineSequence;
+	Ar << Timestamp;
+	Ar.SerializeIntPacked(PayloadBits);
+
+	if (Ar.IsLoading())
+	{
+		if (PayloadBits > MaxPayloadBits)
+		{
+			Ar.SetError();
+			bOutSuccess = false;
+			return true;
+		}
+
+		Payload.SetNumZeroed(FMath::DivideAndRoundUp(PayloadBits, 8u));
+	}
+	else if (Payload.Num() * 8 < static_cast<int32>(PayloadBits))
+	{
+		Ar.SetError();
+		bOutSuccess = false;
+		return true;
+	}
+
+	Ar.SerializeBits(Payload.GetData(), PayloadBits);
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
+float FSHandPoseNet::GetDefaultRadius(const int32 Keypoint)
+{
+	return DefaultRadii[Keypoint];
+}
+
+void FSHandPoseNet::Encode(const FFSQuantizedHandPose& Pose, const FFSQuantizedHandPose* Baseline,
+                           FFSNetHandPose& OutNetPose)
+{
+	FBitWriter Writer(FFSNetHandPose::MaxPayloadBits, true);
+	Writer.WriteBit(Pose.bValid ? 1 : 0);
+
+	if (Pose.bValid)
+	{
+		const bool bDelta = Baseline != nullptr && Baseline->bValid;
+
+		for (int32 Axis = 0; Axis < 3; Axis++)
+			WriteValue(Writer, Pose.PalmPosition[Axis], bDelta ? Baseline->PalmPosition[Axis] : 0);
+
+		WriteRotation(Writer, Pose.PalmRotation, bDelta ? &Baseline->PalmRotation : nullptr);
+
+		// The palm is the origin of the other keypoints, its local transform is always identity.
+		for (int32 i = 0; i < FSHandSkeleton::KeypointCount; i++)
+		{
+			if (i == FSHandSkeleton::Palm) continue;
+
+			for (int32 Axis = 0; Axis < 3; Axis++)
+				WriteValue(Writer, Pose.Positions[i][Axis], bDelta ? Baseline->Positions[i][Axis] : 0);
+
+			WriteRotation(Writer, Pose.Rotations[i], bDelta ? &Baseline->Rotations[i] : nullptr);
+		}
+	}
+
+	// Only the written bytes, the payload keeps its allocation between poses.
+	OutNetPose.PayloadBits = static_cast<uint32>(Writer.GetNumBits());
+	OutNetPose.Payload.SetNumUninitialized(FMath::DivideAndRoundUp(OutNetPose.PayloadBits, 8u), EAllowShrinking::No);
+	FMemory::Memcpy(OutNetPose.Payload.GetData(), Writer.GetData(), OutNetPose.Payload.Num());
+}
+
+bool FSHandPoseNet::Decode(const FFSNetHandPose& NetPose, const FFSQuantizedHandPose* Baseline,
+                           FFSQuantizedHandPose& OutPose)
+{
+	FBitReader Reader(const_cast<uint8*>(NetPose.Payload.GetData()), NetPose.PayloadBits);
+	OutPose.bValid = Reader.ReadBit() != 0;
+
+	if (OutPose.bValid)
+	{
+		const bool bDelta = Baseline != nullptr && Baseline->bValid;
+
+		for (int32 Axis = 0; Axis < 3; Axis++)
+			OutPose.PalmPosition[Axis] = ReadValue(Reader, bDelta ? Baseline->PalmPosition[Axis] : 0);
+
+		OutPose.PalmRotation = ReadRotation(Reader, bDelta ? &Baseline->PalmRotation : nullptr);
+
+		for (int32 i = 0; i < FSHandSkeleton::KeypointCount; i++)
+		{
+			if (i == FSHandSkeleton::Palm)
+			{
+				OutPose.Positions[i][0] = OutPose.Positions[i][1] = OutPose.Positions[i][2] = 0;
+				OutPose.Rotations[i] = FFSQuantizedHandPose::PackRotation(FQuat::Identity);
+				continue;
+			}
+
+			for (int32 Axis = 0; Axis < 3; Axis++)
+			{
+				OutPose.Positions[i][Axis] = static_cast<int16>(
+					ReadValue(Reader, bDelta ? Baseline->Positions[i][Axis] : 0));
+			}
+
+			OutPose.Rotations[i] = ReadRotation(Reader, bDelta ? &Baseline->Rotations[i] : nullptr);
+		}
+	}
+
+	return !Reader.IsError();
+}
+
+void FFSHandPoseNetSender::Encode(const FXRMotionControllerData& InData, FFSNetHandPose& OutNetPose)
+{
+	const int32 Slot = NextSequence % HistorySize;
+	History[Slot].Quantize(InData);
+	HistorySequences[Slot] = NextSequence;
+
+	// Fall back to a keyframe when the acknowledged pose left the history.
+	const FFSQuantizedHandPose* Baseline = nullptr;
+
+	if (AckedSequence != 0 && static_cast<uint16>(NextSequence - AckedSequence) < HistorySize)
+	{
+		const int32 BaselineSlot = AckedSequence % HistorySize;
+
+		if (HistorySequences[BaselineSlot] == AckedSequence)
+			Baseline = &History[BaselineSlot];
+	}
+
+	OutNetPose.Sequence = NextSequence;
+	OutNetPose.BaselineSequence = Baseline != nullptr ? AckedSequence : 0;
+	OutNetPose.Timestamp = static_cast<uint32>(FPlatformTime::Seconds() * 1000.0);
+	FSHandPoseNet::Encode(History[Slot], Baseline, OutNetPose);
+
+	// 0 means "no sequence"
+	NextSequence++;
+	if (NextSequence == 0)
+		NextSequence = 1;
+}
+
+void FFSHandPoseNetSender::Acknowledge(const uint16 Sequence)
+{
+	if (Sequence == 0) return;
+
+	if (AckedSequence == 0 || static_cast<int16>(Sequence - AckedSequence) > 0)
+		AckedSequence = Sequence;
+}
+
+bool FFSHandPoseNetReceiver::Receive(const FFSNetHandPose& NetPose, const double LocalTime)
+{
+	if (NetPose.Sequence == 0) return false;
+
+	// Out of order poses are dropped.
+	if (LastSequence != 0 && static_cast<int16>(NetPose.Sequence - LastSequence) <= 0)
+		return false;
+
+	const FFSQuantizedHandPose* Baseline = nullptr;
+
+	if (NetPose.BaselineSequence != 0)
+	{
+		const int32 BaselineSlot = NetPose.BaselineSequence % HistorySize;
+		if (HistorySequences[BaselineSlot] != NetPose.BaselineSequence) return false;
+
+		Baseline = &History[BaselineSlot];
+	}
+
+	FFSQuantizedHandPose Pose;
+	if (!FSHandPoseNet::Decode(NetPose, Baseline, Pose)) return false;
+
+	const int32 Slot = NetPose.Sequence % HistorySize;
+	History[Slot] = Pose;
+	HistorySequences[Slot] = NetPose.Sequence;
+	LastSequence = NetPose.Sequence;
+
+	// Keep the smallest observed offset (least delayed packet), relaxed slowly to follow clock drift.
+	const double SenderTime = NetPose.Timestamp / 1000.0;
+	const double Offset = LocalTime - SenderTime;
+	ClockOffset = bHasClockOffset ? FMath::Min(Offset, ClockOffset + 0.001) : Offset;
+	bHasClockOffset = true;
+
+	FBufferedPose& Buffered = Buffer[BufferHead];
+	Buffered.Time = SenderTime;
+	Buffered.bValid = Pose.bValid;
+
+	if (Pose.bValid)
+		Pose.Dequantize(Buffered.Positions, Buffered.Rotations);
+
+	BufferHead = (BufferHead + 1) % BufferSize;
+	BufferCount = FMath::Min(BufferCount + 1, BufferSize);
+	return true;
+}
+
+bool FFSHandPoseNetReceiver::Sample(const double LocalTime, const bool bLeft, FXRMotionControllerData& OutData) const
+{
+	if (BufferCount == 0) return false;
+
+	const double TargetTime = LocalTime - ClockOffset - InterpolationDelay;
+	const int32 Oldest = (BufferHead - BufferCount + BufferSize) % BufferSize;
+
+	// Find the poses around the target time, clamp to the buffer range.
+	const FBufferedPose* From = &Buffer[Oldest];
+	const FBufferedPose* To = From;
+
+	for (int32 i = 1; i < BufferCount; i++)
+	{
+		const FBufferedPose& Candidate = Buffer[(Oldest + i) % BufferSize];
+		To = &Candidate;
+
+		if (Candidate.Time > TargetTime) break;
+
+		From = &Candidate;
+	}
+
+	const double Range = To->Time - From->Time;
+	const float Alpha = Range > 0.0 ? static_cast<float>(FMath::Clamp((TargetTime - From->Time) / Range, 0.0, 1.0)) : 0.0f;
+
+	// Validity changes are not interpolated.
+	if (!From->bValid || !To->bValid)
+	{
+		From = Alpha < 0.5f ? From : To;
+		To = From;
+	}
+
+	constexpr int32 Count = FSHandSkeleton::KeypointCount;
+
+	OutData.bValid = From->bValid;
+	OutData.HandIndex = bLeft ? EControllerHand::Left : EControllerHand::Right;
+	OutData.DeviceVisualType = EXRVisualType::Hand;
+	OutData.TrackingStatus = OutData.bValid ? ETrackingStatus::Tracked : ETrackingStatus::NotTracked;
+	OutData.HandKeyPositions.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutData.HandKeyRotations.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutData.HandKeyRadii.SetNumUninitialized(Count, EAllowShrinking::No);
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		OutData.HandKeyPositions[i] = FMath::Lerp(From->Positions[i], To->Positions[i], Alpha);
+		OutData.HandKeyRotations[i] = FQuat::Slerp(From->Rotations[i], To->Rotations[i], Alpha);
+		OutData.HandKeyRadii[i] = DefaultRadii[i];
+	}
+
+	OutData.PalmPosition = OutData.HandKeyPositions[FSHandSkeleton::Palm];
+	OutData.PalmRotation = OutData.HandKeyRotations[FSHandSkeleton::Palm];
+	OutData.GripPosition = OutData.PalmPosition;
+	OutData.GripRotation = OutData.PalmRotation;
+	return true;
+}
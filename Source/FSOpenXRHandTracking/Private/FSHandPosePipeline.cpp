@@ -0,0 +1,156 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FSHandPosePipeline.h"
+#include "FSHandTrackingStats.h"
+#include "RenderingThread.h"
+#include "Tasks/Task.h"
+
+void FFSHandPosePipeline::ProcessPose(const FXRMotionControllerData& InData, const FFSHandProcessSettings& Settings,
+                                      const double SampleTime, FFSHandProcessState& State,
+                                      FFSHandPoseSnapshot& OutPose)
+{
+	constexpr int32 Count = FSHandSkeleton::KeypointCount;
+
+	OutPose.SampleTime = SampleTime;
+	OutPose.bValid = InData.bValid && InData.HandKeyPositions.Num() == Count &&
+		InData.HandKeyRotations.Num() == Count && InData.HandKeyRadii.Num() == Count;
+
+	if (!OutPose.bValid)
+	{
+		State.Reset();
+		OutPose.PinchMask = 0;
+
+		for (float& Strength : OutPose.PinchStrengths)
+			Strength = 0.0f;
+
+		return;
+	}
+
+	for (int32 i = 0; i < Count; i++)
+		OutPose.Radii[i] = InData.HandKeyRadii[i];
+
+	// Pinches are detected on the filtered pose, the prediction could overshoot and trigger false positives.
+	FVector FilteredLocations[Count];
+	const FVector* PinchLocations = OutPose.Locations;
+
+	if (Settings.Filter.bEnabled)
+	{
+		FS_HAND_TRACKING_SCOPE(Filter);
+		State.Filter.Update(InData.HandKeyPositions.GetData(), InData.HandKeyRotations.GetData(), SampleTime,
+		                    Settings.Filter, FilteredLocations, OutPose.Locations, OutPose.Rotations);
+		PinchLocations = FilteredLocations;
+	}
+	else
+	{
+		State.Filter.Reset();
+
+		for (int32 i = 0; i < Count; i++)
+		{
+			OutPose.Locations[i] = InData.HandKeyPositions[i];
+			OutPose.Rotations[i] = InData.HandKeyRotations[i];
+		}
+	}
+
+	{
+		FS_HAND_TRACKING_SCOPE(Pinch);
+		State.PinchDetector.Update(MakeArrayView(PinchLocations, Count), Settings.PinchThreshold,
+		                           Settings.PinchReleaseThreshold, Settings.PinchStrengthDistance);
+		OutPose.PinchMask = State.PinchDetector.GetPinchMask();
+
+		for (int32 Finger = 0; Finger < FFSPinchDetector::FingerCount; Finger++)
+			OutPose.PinchStrengths[Finger] = State.PinchDetector.GetStrength(Finger);
+	}
+
+#if !WITH_METAXR
+	if (Settings.bComputeRelativeRotations)
+	{
+		FS_HAND_TRACKING_SCOPE(RelativeRotations);
+		FFSHandQuatBuffer WorldRotations;
+		WorldRotations.Load(MakeArrayView(OutPose.Rotations));
+		FSHandPose::ComputeRelativeRotations(WorldRotations, OutPose.RelativeRotations);
+		OutPose.GestureFeatures = FFSHandGestureFeatures::FromRelativeRotations(OutPose.RelativeRotations);
+		return;
+	}
+#endif
+
+	// Not computed for this pose, identity rather than the rotations of an older one.
+	OutPose.RelativeRotations.Reset();
+	OutPose.GestureFeatures = FFSHandGestureFeatures();
+}
+
+void FFSHandPosePipeline::Submit(const FXRMotionControllerData& InData, const FFSHandProcessSettings& Settings)
+{
+	FRawInput& Raw = Input.GetWriteBuffer();
+	Raw.Data = InData;
+	Raw.Settings = Settings;
+	Raw.SampleTime = FPlatformTime::Seconds();
+	Input.SwapWriteBuffers();
+
+	bool bExpected = false;
+
+	if (bWorkerRunning.compare_exchange_strong(bExpected, true))
+	{
+		UE::Tasks::Launch(UE_SOURCE_LOCATION, [Pipeline = AsShared()]()
+		{
+			Pipeline->RunWorker();
+		});
+	}
+}
+
+void FFSHandPosePipeline::RunWorker()
+{
+	do
+	{
+		// Only the most recent input is processed, older ones are skipped.
+		while (Input.IsDirty())
+		{
+			Input.SwapReadBuffers();
+			const FRawInput& Raw = Input.Read();
+
+			FFSHandPoseSnapshot& GamePose = GameOutput.GetWriteBuffer();
+			ProcessPose(Raw.Data, Raw.Settings, Raw.SampleTime, State, GamePose);
+
+			RenderOutput.GetWriteBuffer() = GamePose;
+			RenderOutput.SwapWriteBuffers();
+			GameOutput.SwapWriteBuffers();
+		}
+
+		bWorkerRunning.store(false);
+
+		// Data submitted between the last check and the flag reset would be lost otherwise.
+		bool bExpected = false;
+		if (!Input.IsDirty() || !bWorkerRunning.compare_exchange_strong(bExpected, true))
+			break;
+	}
+	while (true);
+}
+
+const FFSHandPoseSnapshot& FFSHandPosePipeline::ReadLatest()
+{
+	if (GameOutput.IsDirty())
+		GameOutput.SwapReadBuffers();
+
+	return GameOutput.Read();
+}
+
+const FFSHandPoseSnapshot& FFSHandPosePipeline::LatchRenderThread()
+{
+	if (RenderOutput.IsDirty())
+		RenderOutput.SwapReadBuffers();
+
+	const FFSHandPoseSnapshot& Pose = RenderOutput.Read();
+
+	if (OnLateLatch_RenderThread)
+		OnLateLatch_RenderThread(Pose);
+
+	return Pose;
+}
+
+void FFSHandPosePipeline::SetOnLateLatch_RenderThread(TFunction<void(const FFSHandPoseSnapshot&)>&& Callback)
+{
+	ENQUEUE_RENDER_COMMAND(FSHandSetLateLatch)(
+		[Pipeline = AsShared(), Callback = MoveTemp(Callback)](FRHICommandListImmediate&) mutable
+		{
+			Pipeline->OnLateLatch_RenderThread = MoveTemp(Callback);
+		});
+}
@@ -0,0 +1,205 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FSHandPoseRecording.h"
+#include "FSOpenXRHandTracking.h"
+#include "Algo/BinarySearch.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+
+void FFSHandPoseFrame::Store(const FXRMotionControllerData& InData, const double InTimestamp)
+{
+	FMemory::Memzero(*this);
+
+	Timestamp = InTimestamp;
+	HandIndex = static_cast<uint8>(InData.HandIndex);
+	bValid = InData.bValid ? 1 : 0;
+	TrackingStatus = static_cast<uint8>(InData.TrackingStatus);
+
+	const int32 Count = FMath::Min3(InData.HandKeyPositions.Num(), InData.HandKeyRotations.Num(),
+	                                InData.HandKeyRadii.Num());
+
+	for (int32 i = 0; i < FMath::Min(Count, FSHandSkeleton::KeypointCount); i++)
+	{
+		const FVector& Position = InData.HandKeyPositions[i];
+		const FQuat& Rotation = InData.HandKeyRotations[i];
+
+		Positions[i][0] = static_cast<float>(Position.X);
+		Positions[i][1] = static_cast<float>(Position.Y);
+		Positions[i][2] = static_cast<float>(Position.Z);
+		Rotations[i][0] = static_cast<float>(Rotation.X);
+		Rotations[i][1] = static_cast<float>(Rotation.Y);
+		Rotations[i][2] = static_cast<float>(Rotation.Z);
+		Rotations[i][3] = static_cast<float>(Rotation.W);
+		Radii[i] = InData.HandKeyRadii[i];
+	}
+}
+
+void FFSHandPoseFrame::Load(FXRMotionControllerData& OutData) const
+{
+	constexpr int32 Count = FSHandSkeleton::KeypointCount;
+
+	OutData.bValid = bValid != 0;
+	OutData.HandIndex = static_cast<EControllerHand>(HandIndex);
+	OutData.TrackingStatus = static_cast<ETrackingStatus>(TrackingStatus);
+	OutData.DeviceVisualType = EXRVisualType::Hand;
+
+	// Only allocates the first time the struct is used.
+	OutData.HandKeyPositions.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutData.HandKeyRotations.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutData.HandKeyRadii.SetNumUninitialized(Count, EAllowShrinking::No);
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		OutData.HandKeyPositions[i] = FVector(Positions[i][0], Positions[i][1], Positions[i][2]);
+		OutData.HandKeyRotations[i] = FQuat(Rotations[i][0], Rotations[i][1], Rotations[i][2], Rotations[i][3]);
+		OutData.HandKeyRadii[i] = Radii[i];
+	}
+
+	OutData.PalmPosition = OutData.HandKeyPositions[FSHandSkeleton::Palm];
+	OutData.PalmRotation = OutData.HandKeyRotations[FSHandSkeleton::Palm];
+	OutData.GripPosition = OutData.PalmPosition;
+	OutData.GripRotation = OutData.PalmRotation;
+}
+
+FFSHandPoseRecorder::~FFSHandPoseRecorder()
+{
+	Close();
+}
+
+bool FFSHandPoseRecorder::Open(const FString& Filename)
+{
+	Close();
+
+	Writer.Reset(IFileManager::Get().CreateFileWriter(*Filename));
+	if (!Writer.IsValid()) return false;
+
+	FFSHandPoseFileHeader Header;
+	Header.Magic = FFSHandPoseFileHeader::ExpectedMagic;
+	Header.Version = FFSHandPoseFileHeader::CurrentVersion;
+	Header.HeaderSize = sizeof(FFSHandPoseFileHeader);
+	Header.FrameSize = sizeof(FFSHandPoseFrame);
+	Header.KeypointCount = FSHandSkeleton::KeypointCount;
+	Header.Reserved = 0;
+	Writer->Serialize(&Header, sizeof(Header));
+
+	StartTime = FPlatformTime::Seconds();
+	FrameCount = 0;
+	return true;
+}
+
+void FFSHandPoseRecorder::Close()
+{
+	if (!Writer.IsValid()) return;
+
+	Writer->Close();
+	Writer.Reset();
+}
+
+void FFSHandPoseRecorder::Record(const FXRMotionControllerData& InData)
+{
+	if (!Writer.IsValid()) return;
+
+	FFSHandPoseFrame Frame;
+	Frame.Store(InData, FPlatformTime::Seconds() - StartTime);
+	Writer->Serialize(&Frame, sizeof(Frame));
+	FrameCount++;
+}
+
+FFSHandPosePlayer::~FFSHandPosePlayer()
+{
+	Close();
+}
+
+bool FFSHandPosePlayer::Open(const FString& Filename)
+{
+	Close();
+
+	MappedHandle.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Filename));
+	if (!MappedHandle.IsValid()) return false;
+
+	const int64 FileSize = MappedHandle->GetFileSize();
+	if (FileSize < static_cast<int64>(sizeof(FFSHandPoseFileHeader)))
+	{
+		Close();
+		return false;
+	}
+
+	MappedRegion.Reset(MappedHandle->MapRegion(0, FileSize));
+	if (!MappedRegion.IsValid())
+	{
+		Close();
+		return false;
+	}
+
+	const uint8* Data = MappedRegion->GetMappedPtr();
+	const FFSHandPoseFileHeader* Header = reinterpret_cast<const FFSHandPoseFileHeader*>(Data);
+
+	if (Header->Magic != FFSHandPoseFileHeader::ExpectedMagic ||
+		Header->Version != FFSHandPoseFileHeader::CurrentVersion ||
+		Header->FrameSize != sizeof(FFSHandPoseFrame) ||
+		Header->KeypointCount != FSHandSkeleton::KeypointCount ||
+		// Frames are read in place, they must start inside the file and stay aligned.
+		Header->HeaderSize < sizeof(FFSHandPoseFileHeader) ||
+		Header->HeaderSize > FileSize ||
+		!IsAligned(Header->HeaderSize, 8))
+	{
+		UE_LOG(LogFSHandTracking, Warning, TEXT("FSHandPosePlayer: %s is not a supported capture file"), *Filename);
+		Close();
+		return false;
+	}
+
+	// A truncated last frame (crash during recording) is ignored.
+	FrameCount = static_cast<int32>((FileSize - Header->HeaderSize) / Header->FrameSize);
+	Frames = reinterpret_cast<const FFSHandPoseFrame*>(Data + Header->HeaderSize);
+	return true;
+}
+
+void FFSHandPosePlayer::Close()
+{
+	Frames = nullptr;
+	FrameCount = 0;
+	MappedRegion.Reset();
+	MappedHandle.Reset();
+}
+
+double FFSHandPosePlayer::GetDuration() const
+{
+	return FrameCount > 0 ? Frames[FrameCount - 1].Timestamp : 0.0;
+}
+
+int32 FFSHandPosePlayer::FindFrame(const double Time) const
+{
+	if (FrameCount == 0) return INDEX_NONE;
+
+	const double Duration = GetDuration();
+	if (Time <= 0.0 || Duration <= 0.0) return 0;
+	if (Time >= Duration) return FrameCount - 1;
+
+	// Frames are recorded at a near constant rate, start from the estimated index
+	// and walk the few frames of drift.
+	constexpr int32 MaxDriftFrames = 16;
+	int32 Index = FMath::Clamp(static_cast<int32>(Time / Duration * (FrameCount - 1)), 0, FrameCount - 1);
+
+	for (int32 Step = 0; Step < MaxDriftFrames; Step++)
+	{
+		if (Index > 0 && Frames[Index].Timestamp > Time)
+			Index--;
+		else if (Index + 1 < FrameCount && Frames[Index + 1].Timestamp <= Time)
+			Index++;
+		else
+			return Index;
+	}
+
+	// The recording was paused or hitched, binary search on the timestamps.
+	const int32 Upper = Algo::UpperBoundBy(MakeArrayView(Frames, FrameCount), Time, &FFSHandPoseFrame::Timestamp);
+	return FMath::Max(Upper - 1, 0);
+}
+
+bool FFSHandPosePlayer::ReadFrame(const int32 Index, FXRMotionControllerData& OutData) const
+{
+	if (Frames == nullptr || Index < 0 || Index >= FrameCount) return false;
+
+	Frames[Index].Load(OutData);
+	return true;
+}
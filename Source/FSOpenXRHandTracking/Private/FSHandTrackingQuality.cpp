@@ -0,0 +1,249 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FSHandTrackingQuality.h"
+#include "FSHandTrackingStats.h"
+
+namespace
+{
+	FORCEINLINE uint32 FloatToBits(const float Value)
+	{
+		uint32 Bits;
+		FMemory::Memcpy(&Bits, &Value, sizeof(Bits));
+		return Bits;
+	}
+
+	FORCEINLINE float BitsToFloat(const uint32 Bits)
+	{
+		float Value;
+		FMemory::Memcpy(&Value, &Bits, sizeof(Value));
+		return Value;
+	}
+}
+
+FFSRollingHistogram::FFSRollingHistogram(const float InResolution)
+	: CurrentSlice(0)
+	, Resolution(FMath::Max(InResolution, UE_SMALL_NUMBER))
+{
+	Reset();
+}
+
+void FFSRollingHistogram::Add(const float Value)
+{
+	const float ClampedValue = FMath::Max(Value, 0.0f);
+	const int32 Bucket = ClampedValue > Resolution ? FMath::CeilToInt32(FMath::Log2(ClampedValue / Resolution)) : 0;
+
+	FSlice& Slice = Slices[CurrentSlice.load(std::memory_order_relaxed)];
+	Slice.Buckets[FMath::Min(Bucket, BucketCount - 1)].fetch_add(1, std::memory_order_relaxed);
+
+	// Single writer, no compare exchange needed.
+	if (ClampedValue > BitsToFloat(Slice.MaxBits.load(std::memory_order_relaxed)))
+		Slice.MaxBits.store(FloatToBits(ClampedValue), std::memory_order_relaxed);
+}
+
+void FFSRollingHistogram::Rotate()
+{
+	const int32 Next = (CurrentSlice.load(std::memory_order_relaxed) + 1) % SliceCount;
+	FSlice& Slice = Slices[Next];
+
+	for (std::atomic<uint32>& Bucket : Slice.Buckets)
+		Bucket.store(0, std::memory_order_relaxed);
+
+	Slice.MaxBits.store(0, std::memory_order_relaxed);
+	CurrentSlice.store(Next, std::memory_order_release);
+}
+
+void FFSRollingHistogram::Reset()
+{
+	for (FSlice& Slice : Slices)
+	{
+		for (std::atomic<uint32>& Bucket : Slice.Buckets)
+			Bucket.store(0, std::memory_order_relaxed);
+
+		Slice.MaxBits.store(0, std::memory_order_relaxed);
+	}
+}
+
+uint32 FFSRollingHistogram::GetCount() const
+{
+	uint32 Count = 0;
+
+	for (const FSlice& Slice : Slices)
+	{
+		for (const std::atomic<uint32>& Bucket : Slice.Buckets)
+			Count += Bucket.load(std::memory_order_relaxed);
+	}
+
+	return Count;
+}
+
+float FFSRollingHistogram::GetPercentile(const float Percentile) const
+{
+	uint32 Counts[BucketCount] = {};
+	uint32 Total = 0;
+
+	for (const FSlice& Slice : Slices)
+	{
+		for (int32 Bucket = 0; Bucket < BucketCount; Bucket++)
+			Counts[Bucket] += Slice.Buckets[Bucket].load(std::memory_order_relaxed);
+	}
+
+	for (const uint32 Count : Counts)
+		Total += Count;
+
+	if (Total == 0) return 0.0f;
+
+	const double Fraction = FMath::Clamp(Percentile, 0.0f, 1.0f);
+	const uint32 Rank = FMath::Max(1u, static_cast<uint32>(FMath::CeilToDouble(Fraction * Total)));
+	uint32 Cumulated = 0;
+
+	for (int32 Bucket = 0; Bucket < BucketCount; Bucket++)
+	{
+		Cumulated += Counts[Bucket];
+
+		if (Cumulated >= Rank)
+			return FMath::Min(GetBucketBound(Bucket), GetMax());
+	}
+
+	return GetMax();
+}
+
+float FFSRollingHistogram::GetMax() const
+{
+	float Max = 0.0f;
+
+	for (const FSlice& Slice : Slices)
+		Max = FMath::Max(Max, BitsToFloat(Slice.MaxBits.load(std::memory_order_relaxed)));
+
+	return Max;
+}
+
+FFSHandQualityStats FFSRollingHistogram::GetStats() const
+{
+	FFSHandQualityStats Stats;
+	Stats.Count = static_cast<int32>(GetCount());
+	Stats.Median = GetPercentile(0.5f);
+	Stats.P95 = GetPercentile(0.95f);
+	Stats.Max = GetMax();
+	return Stats;
+}
+
+FFSHandTrackingQuality::FFSHandTrackingQuality()
+	// Jitter in cm, times in ms.
+	: Histograms{FFSRollingHistogram(0.001f), FFSRollingHistogram(0.1f), FFSRollingHistogram(1.0f),
+	             FFSRollingHistogram(1.0f)}
+	, DropoutCount(0)
+{
+	Reset();
+}
+
+void FFSHandTrackingQuality::Reset()
+{
+	for (FFSRollingHistogram& Histogram : Histograms)
+		Histogram.Reset();
+
+	DropoutCount.store(0, std::memory_order_relaxed);
+	PreviousCount = 0;
+	LastSampleTime = 0.0;
+	LostTime = 0.0;
+	RegainedTime = 0.0;
+	NextRotationTime = 0.0;
+	bWasTracked = false;
+	bHasBeenTracked = false;
+	bRecovering = false;
+}
+
+void FFSHandTrackingQuality::Update(const double Now, const bool bTracked, const FVector* Locations,
+                                    const double SampleTime)
+{
+	if (Now >= NextRotationTime)
+	{
+		if (NextRotationTime > 0.0)
+		{
+			for (FFSRollingHistogram& Histogram : Histograms)
+				Histogram.Rotate();
+		}
+
+		NextRotationTime = Now + FMath::Max(WindowDuration, 0.1f) / FFSRollingHistogram::SliceCount;
+	}
+
+	// Tracking transitions, a hand that was never tracked isn't a dropout.
+	if (bTracked != bWasTracked)
+	{
+		bWasTracked = bTracked;
+		PreviousCount = 0;
+
+		if (!bTracked)
+		{
+			LostTime = Now;
+			bRecovering = false;
+			DropoutCount.fetch_add(1, std::memory_order_relaxed);
+			FS_HAND_TRACKING_COUNT(Dropouts, 1);
+		}
+		else
+		{
+			if (bHasBeenTracked)
+			{
+				AddSample(EFSHandQualityMetric::DropoutDuration, static_cast<float>((Now - LostTime) * 1000.0));
+				RegainedTime = Now;
+				bRecovering = true;
+			}
+
+			bHasBeenTracked = true;
+		}
+	}
+
+	if (!bTracked) return;
+
+	AddSample(EFSHandQualityMetric::PoseAge, static_cast<float>(FMath::Max(Now - SampleTime, 0.0) * 1000.0));
+
+	// Async pipelines can deliver the same pose twice.
+	if (SampleTime == LastSampleTime && PreviousCount > 0) return;
+
+	LastSampleTime = SampleTime;
+
+	if (PreviousCount >= 2)
+	{
+		float Jitter = 0.0f;
+
+		for (int32 i = 0; i < FSHandSkeleton::KeypointCount; i++)
+		{
+			Jitter += static_cast<float>(
+				(Locations[i] - 2.0 * PreviousLocations[0][i] + PreviousLocations[1][i]).Size());
+		}
+
+		Jitter /= FSHandSkeleton::KeypointCount;
+		AddSample(EFSHandQualityMetric::Jitter, Jitter);
+
+		if (bRecovering && Jitter <= RecoveryJitterThreshold)
+		{
+			AddSample(EFSHandQualityMetric::RecoveryTime, static_cast<float>((Now - RegainedTime) * 1000.0));
+			bRecovering = false;
+		}
+	}
+
+	FMemory::Memcpy(PreviousLocations[1], PreviousLocations[0], sizeof(PreviousLocations[0]));
+	FMemory::Memcpy(PreviousLocations[0], Locations, sizeof(PreviousLocations[0]));
+	PreviousCount = FMath::Min(PreviousCount + 1, 2);
+}
+
+void FFSHandTrackingQuality::AddSample(const EFSHandQualityMetric Metric, const float Value)
+{
+	Histograms[static_cast<int32>(Metric)].Add(Value);
+
+	// Worst value of the frame over every hand, next to the frame times of the CSV profile.
+	switch (Metric)
+	{
+	case EFSHandQualityMetric::Jitter:
+		FS_HAND_TRACKING_QUALITY(JitterCm, Value);
+		break;
+	case EFSHandQualityMetric::PoseAge:
+		FS_HAND_TRACKING_QUALITY(PoseAgeMs, Value);
+		break;
+	case EFSHandQualityMetric::DropoutDuration:
+		FS_HAND_TRACKING_QUALITY(DropoutMs, Value);
+		break;
+	case EFSHandQualityMetric::RecoveryTime:
+		FS_HAND_TRACKING_QUALITY(RecoveryMs, Value);
+		break;
+	}
+}
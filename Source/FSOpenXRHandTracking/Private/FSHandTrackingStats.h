@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("FSHandTracking"), STATGROUP_FSHandTracking, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Subsystem Tick"), STAT_FSHandTracking_SubsystemTick, STATGROUP_FSHandTracking, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Process Hand"), STAT_FSHandTracking_ProcessHand, STATGROUP_FSHandTracking, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Apply Hand"), STAT_FSHandTracking_ApplyHand, STATGROUP_FSHandTracking, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Filter"), STAT_FSHandTracking_Filter, STATGROUP_FSHandTracking, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Pinch Detection"), STAT_FSHandTracking_Pinch, STATGROUP_FSHandTracking, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Relative Rotations"), STAT_FSHandTracking_RelativeRotations, STATGROUP_FSHandTracking, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Instances"), STAT_FSHandTracking_Instances, STATGROUP_FSHandTracking, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Wireframe"), STAT_FSHandTracking_Wireframe, STATGROUP_FSHandTracking, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Collision"), STAT_FSHandTracking_Collision, STATGROUP_FSHandTracking, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Input Injection"), STAT_FSHandTracking_InputInjection, STATGROUP_FSHandTracking, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Hand Pointer"), STAT_FSHandTracking_HandPointer, STATGROUP_FSHandTracking, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Hand Rays"), STAT_FSHandTracking_HandRays, STATGROUP_FSHandTracking, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Gestures"), STAT_FSHandTracking_Gestures, STATGROUP_FSHandTracking, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Anim Node Evaluate"), STAT_FSHandTracking_AnimNodeEvaluate, STATGROUP_FSHandTracking, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Get Data From Skeleton"), STAT_FSHandTracking_GetDataFromSkeleton,
+                          STATGROUP_FSHandTracking, );
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Instances Touched"), STAT_FSHandTracking_InstancesTouched,
+                                  STATGROUP_FSHandTracking, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Input Injections"), STAT_FSHandTracking_InputInjections,
+                                  STATGROUP_FSHandTracking, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Tracking Flips"), STAT_FSHandTracking_TrackingFlips,
+                                  STATGROUP_FSHandTracking, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Unchanged Poses"), STAT_FSHandTracking_UnchangedPoses,
+                                  STATGROUP_FSHandTracking, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Hand Ray Traces"), STAT_FSHandTracking_HandRayTraces,
+                                  STATGROUP_FSHandTracking, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Hands Deferred"), STAT_FSHandTracking_HandsDeferred,
+                                  STATGROUP_FSHandTracking, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Dropouts"), STAT_FSHandTracking_Dropouts, STATGROUP_FSHandTracking, );
+
+CSV_DECLARE_CATEGORY_EXTERN(FSHandTracking);
+
+// Cycle counter, Insights CPU scope and CSV timer of a stage, e.g. FS_HAND_TRACKING_SCOPE(Wireframe).
+#define FS_HAND_TRACKING_SCOPE(Stage) \
+	SCOPE_CYCLE_COUNTER(STAT_FSHandTracking_##Stage); \
+	TRACE_CPUPROFILER_EVENT_SCOPE(FSHandTracking_##Stage); \
+	CSV_SCOPED_TIMING_STAT(FSHandTracking, Stage)
+
+// Per-frame counter, in the stat group and in the CSV profile.
+#define FS_HAND_TRACKING_COUNT(Counter, Value) \
+	INC_DWORD_STAT_BY(STAT_FSHandTracking_##Counter, Value); \
+	CSV_CUSTOM_STAT(FSHandTracking, Counter, static_cast<int32>(Value), ECsvCustomStatOp::Accumulate)
+
+// Worst value of a tracking quality metric during the frame, in the CSV profile.
+#define FS_HAND_TRACKING_QUALITY(Metric, Value) \
+	CSV_CUSTOM_STAT(FSHandTracking, Metric, static_cast<float>(Value), ECsvCustomStatOp::Max)
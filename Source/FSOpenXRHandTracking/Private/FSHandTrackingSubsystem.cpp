@@ -0,0 +1,235 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FSHandTrackingSubsystem.h"
+#include "FSInstancedHand.h"
+#include "FSHandInstanceRenderer.h"
+#include "FSHandTrackingStats.h"
+#include "HeadMountedDisplayFunctionLibrary.h"
+#include "Async/ParallelFor.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Kismet/GameplayStatics.h"
+
+namespace
+{
+	// Hands drawn in this interval (s) are considered visible.
+	constexpr float RenderedTolerance = 0.2f;
+	// Significance of hands that are off-screen or occluded.
+	constexpr float HiddenSignificanceScale = 0.25f;
+}
+
+bool UFSHandTrackingSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UFSHandTrackingSubsystem::Deinitialize()
+{
+	for (UFSHandInstanceRenderer* Renderer : SharedRenderers)
+	{
+		if (Renderer != nullptr)
+			Renderer->DestroyComponent();
+	}
+
+	SharedRenderers.Reset();
+	Super::Deinitialize();
+}
+
+void UFSHandTrackingSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	FS_HAND_TRACKING_SCOPE(SubsystemTick);
+
+	// Bounds of the interactables are shared by every hand.
+	Interactables.RefreshBounds();
+
+	UpdateHands(DeltaTime);
+	TraceHandRays();
+
+	OnHandsUpdated.Broadcast(DeltaTime);
+}
+
+void UFSHandTrackingSubsystem::UpdateHands(const float DeltaTime)
+{
+	// Schedule
+	FVector ViewLocation;
+	const APlayerCameraManager* CameraManager = UGameplayStatics::GetPlayerCameraManager(GetWorld(), 0);
+
+	if (CameraManager != nullptr)
+		ViewLocation = CameraManager->GetCameraLocation();
+
+	Candidates.Reset();
+
+	for (int32 i = 0; i < Hands.Num(); i++)
+	{
+		UFSInstancedHand* Hand = Hands[i];
+
+		if (Hand == nullptr || Hand->UpdateMode == EFSOpenXRHandUpdateMode::Manual) continue;
+
+		FHandSchedule& Schedule = Schedules[i];
+		Schedule.FramesSinceUpdate++;
+		Schedule.PendingDeltaTime += DeltaTime;
+
+		if (Hand->UpdateMode == EFSOpenXRHandUpdateMode::Submitted && bScheduleSubmittedHands)
+		{
+			ScheduleHand(Hand, Schedule, CameraManager != nullptr ? &ViewLocation : nullptr);
+
+			if (Schedule.FramesSinceUpdate < GetUpdateInterval(Hand->DetailLevel)) continue;
+		}
+		else
+		{
+			Schedule.Priority = MAX_flt;
+		}
+
+		Candidates.Add(i);
+	}
+
+	// Budget
+	if (MaxHandsPerFrame > 0 && Candidates.Num() > MaxHandsPerFrame)
+	{
+		Candidates.Sort([this](const int32 A, const int32 B)
+		{
+			return Schedules[A].Priority > Schedules[B].Priority;
+		});
+
+		FS_HAND_TRACKING_COUNT(HandsDeferred, Candidates.Num() - MaxHandsPerFrame);
+		Candidates.SetNum(MaxHandsPerFrame, EAllowShrinking::No);
+	}
+
+	// Gather
+	BatchHands.Reset();
+	BatchDeltaTimes.Reset();
+
+	for (const int32 Index : Candidates)
+	{
+		FHandSchedule& Schedule = Schedules[Index];
+		BatchHands.Add(Hands[Index]);
+		BatchDeltaTimes.Add(Schedule.PendingDeltaTime);
+		Schedule.FramesSinceUpdate = 0;
+		Schedule.PendingDeltaTime = 0.0f;
+	}
+
+	if (BatchHands.Num() == 0) return;
+
+	if (BatchData.Num() < BatchHands.Num())
+		BatchData.SetNum(BatchHands.Num());
+
+	for (int32 i = 0; i < BatchHands.Num(); i++)
+	{
+		UFSInstancedHand* Hand = BatchHands[i];
+
+		if (Hand->UpdateMode == EFSOpenXRHandUpdateMode::Tracking)
+		{
+			UHeadMountedDisplayFunctionLibrary::GetMotionControllerData(
+				Hand, Hand->bLeftHand ? EControllerHand::Left : EControllerHand::Right, BatchData[i]);
+		}
+		else
+		{
+			// Keeps the batch arrays allocations.
+			BatchData[i] = Hand->GetSubmittedData();
+		}
+	}
+
+	// Process poses, each hand only touches its own data.
+	ParallelFor(TEXT("FSHandTracking.ProcessHands"), BatchHands.Num(), 4, [this](const int32 Index)
+	{
+		BatchHands[Index]->ProcessHand(BatchData[Index]);
+	});
+
+	// Apply instances, inputs and events, skipped frames are accumulated in the delta time.
+	for (int32 i = 0; i < BatchHands.Num(); i++)
+		BatchHands[i]->ApplyHand(BatchData[i], BatchDeltaTimes[i]);
+}
+
+void UFSHandTrackingSubsystem::TraceHandRays()
+{
+	FS_HAND_TRACKING_SCOPE(HandRays);
+
+	// Every ray is queued in the same pass, the traces run on worker threads and their results are
+	// delivered to the hands at the start of the next frame.
+	for (UFSInstancedHand* Hand : Hands)
+	{
+		if (Hand != nullptr)
+			Hand->TraceHandRay();
+	}
+}
+
+void UFSHandTrackingSubsystem::ScheduleHand(UFSInstancedHand* Hand, FHandSchedule& Schedule,
+                                            const FVector* ViewLocation) const
+{
+	const bool bRendered = Hand->WasHandRecentlyRendered(RenderedTolerance);
+	double Distance = 0.0;
+
+	if (ViewLocation != nullptr)
+	{
+		const FVector HandLocation = Hand->IsHandTracked()
+			                             ? Hand->GetHandTransform().GetLocation()
+			                             : Hand->GetComponentLocation();
+		Distance = FVector::Dist(HandLocation, *ViewLocation);
+	}
+
+	if (!bRendered || Distance >= MinimalDetailDistance)
+		Hand->DetailLevel = EFSOpenXRHandDetail::Minimal;
+	else if (Distance >= ReducedDetailDistance)
+		Hand->DetailLevel = EFSOpenXRHandDetail::Reduced;
+	else
+		Hand->DetailLevel = EFSOpenXRHandDetail::Full;
+
+	// Close and visible hands first, waiting hands slowly catch up.
+	const float Significance = static_cast<float>(1.0 / (1.0 + Distance / FMath::Max(ReducedDetailDistance, 1.0f)));
+	Schedule.Priority = Significance * (bRendered ? 1.0f : HiddenSignificanceScale) * Schedule.FramesSinceUpdate;
+}
+
+int32 UFSHandTrackingSubsystem::GetUpdateInterval(const EFSOpenXRHandDetail Detail) const
+{
+	switch (Detail)
+	{
+	case EFSOpenXRHandDetail::Reduced:
+		return ReducedUpdateInterval;
+	case EFSOpenXRHandDetail::Minimal:
+		return MinimalUpdateInterval;
+	default:
+		return 1;
+	}
+}
+
+TStatId UFSHandTrackingSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFSHandTrackingSubsystem, STATGROUP_Tickables);
+}
+
+void UFSHandTrackingSubsystem::RegisterHand(UFSInstancedHand* Hand)
+{
+	if (Hand == nullptr || Hands.Contains(Hand)) return;
+
+	Hands.Add(Hand);
+	Schedules.AddDefaulted();
+}
+
+void UFSHandTrackingSubsystem::UnregisterHand(UFSInstancedHand* Hand)
+{
+	const int32 Index = Hands.Find(Hand);
+
+	if (Index == INDEX_NONE) return;
+
+	Hands.RemoveAtSwap(Index);
+	Schedules.RemoveAtSwap(Index);
+}
+
+UFSHandInstanceRenderer* UFSHandTrackingSubsystem::GetSharedRenderer(UStaticMesh* Mesh, UMaterialInterface* Material)
+{
+	if (Mesh == nullptr) return nullptr;
+
+	for (UFSHandInstanceRenderer* Renderer : SharedRenderers)
+	{
+		if (Renderer != nullptr && Renderer->GetStaticMesh() == Mesh && Renderer->GetMaterial(0) == Material)
+			return Renderer;
+	}
+
+	// Not attached to any actor, instances are in world space.
+	UFSHandInstanceRenderer* Renderer = NewObject<UFSHandInstanceRenderer>(this, NAME_None, RF_Transient);
+	Renderer->SetStaticMesh(Mesh);
+	Renderer->SetMaterial(0, Material);
+	Renderer->RegisterComponentWithWorld(GetWorld());
+	SharedRenderers.Add(Renderer);
+	return Renderer;
+}
@@ -0,0 +1,322 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FSHandWireframeComponent.h"
+#include "DynamicMeshBuilder.h"
+#include "Engine/Engine.h"
+#include "FSHandPosePipeline.h"
+#include "Materials/Material.h"
+#include "PrimitiveSceneProxy.h"
+#include "SceneManagement.h"
+
+namespace
+{
+	// Bones are 4-sided tubes, joints are octahedrons.
+	constexpr int32 SegmentSides = 4;
+	constexpr int32 SegmentVertexCount = SegmentSides * 2;
+	constexpr int32 SegmentIndexCount = SegmentSides * 6;
+	constexpr int32 JointVertexCount = 6;
+	constexpr int32 JointIndexCount = 8 * 3;
+	constexpr int32 MaxSegmentCount = FSHandSkeleton::KeypointCount;
+
+	struct FWireframeTopology
+	{
+		TArray<TPair<uint8, uint8>, TFixedAllocator<MaxSegmentCount>> Segments;
+		TArray<uint8, TFixedAllocator<FSHandSkeleton::KeypointCount>> Joints;
+
+		int32 GetVertexCount() const
+		{
+			return Segments.Num() * SegmentVertexCount + Joints.Num() * JointVertexCount;
+		}
+	};
+
+	// Same segments as UXRVisualizationFunctionLibrary::RenderFinger.
+	FWireframeTopology BuildTopology(const bool bRenderPalm, const bool bRenderJoints)
+	{
+		FWireframeTopology Topology;
+
+		if (bRenderPalm)
+		{
+			Topology.Segments.Emplace(static_cast<uint8>(FSHandSkeleton::Palm), static_cast<uint8>(FSHandSkeleton::Wrist));
+
+			for (const int32 FingerStart : FSHandSkeleton::FingerStartIndices)
+				Topology.Segments.Emplace(static_cast<uint8>(FSHandSkeleton::Wrist), static_cast<uint8>(FingerStart));
+		}
+
+		for (int32 Finger = 0; Finger < FSHandSkeleton::FingerCount; Finger++)
+		{
+			const int32 FingerTip = FSHandSkeleton::FingerTipIndices[Finger];
+
+			for (int32 Index = FSHandSkeleton::FingerStartIndices[Finger]; Index != FingerTip;
+			     Index = FSHandSkeleton::ChildIndices[Index])
+			{
+				const uint8 ChildIndex = static_cast<uint8>(FSHandSkeleton::ChildIndices[Index]);
+				Topology.Segments.Emplace(static_cast<uint8>(Index), ChildIndex);
+
+				if (bRenderJoints)
+					Topology.Joints.Add(ChildIndex);
+			}
+		}
+
+		return Topology;
+	}
+
+	class FFSHandWireframeSceneProxy final : public FPrimitiveSceneProxy
+	{
+	public:
+		FFSHandWireframeSceneProxy(const UFSHandWireframeComponent* Component, const FFSHandWireframeJoints& Joints)
+			: FPrimitiveSceneProxy(Component)
+			, Topology(BuildTopology(Component->bRenderWireframePalm, Component->bRenderWireframeBones))
+			, Radius(Component->WireframeThickness * 0.5f)
+			, Material(Component->GetMaterial(0))
+			, MaterialRelevance(Component->GetMaterialRelevance(GetScene().GetFeatureLevel()))
+		{
+			// Colors and texture coordinates never change, positions and tangents are written by BuildVertices.
+			Vertices.Init(FDynamicMeshVertex(FVector3f::ZeroVector, FVector2f::ZeroVector, Component->WireframeColor),
+			              Topology.GetVertexCount());
+			Indices.Reserve(Topology.Segments.Num() * SegmentIndexCount + Topology.Joints.Num() * JointIndexCount);
+
+			for (int32 Segment = 0; Segment < Topology.Segments.Num(); Segment++)
+			{
+				const uint32 Base = Segment * SegmentVertexCount;
+
+				for (int32 Side = 0; Side < SegmentSides; Side++)
+				{
+					const uint32 Start0 = Base + Side;
+					const uint32 Start1 = Base + (Side + 1) % SegmentSides;
+					const uint32 End0 = Start0 + SegmentSides;
+					const uint32 End1 = Start1 + SegmentSides;
+
+					Indices.Append({Start0, End0, Start1, Start1, End0, End1});
+				}
+			}
+
+			for (int32 Joint = 0; Joint < Topology.Joints.Num(); Joint++)
+			{
+				const uint32 Base = Topology.Segments.Num() * SegmentVertexCount + Joint * JointVertexCount;
+
+				// Vertices are +X, -X, +Y, -Y, +Z, -Z, one face per octant.
+				for (int32 Octant = 0; Octant < 8; Octant++)
+				{
+					const uint32 X = Base + (Octant & 1);
+					const uint32 Y = Base + 2 + ((Octant >> 1) & 1);
+					const uint32 Z = Base + 4 + ((Octant >> 2) & 1);
+
+					// Odd number of negative axes flips the winding.
+					if (FMath::CountBits(Octant) % 2 == 0)
+						Indices.Append({X, Z, Y});
+					else
+						Indices.Append({X, Y, Z});
+				}
+			}
+
+			BuildVertices(Joints);
+		}
+
+		void SetJoints_RenderThread(const FFSHandWireframeJoints& Joints)
+		{
+			check(IsInRenderingThread());
+			BuildVertices(Joints);
+		}
+
+		// Vertices go to buffers allocated for the frame, the static buffers of a mesh would stall on every lock.
+		virtual void GetDynamicMeshElements(const TArray<const FSceneView*>& Views, const FSceneViewFamily& ViewFamily,
+		                                    uint32 VisibilityMap, FMeshElementCollector& Collector) const override
+		{
+			if (Indices.Num() == 0 || Material == nullptr)
+				return;
+
+			const FMaterialRenderProxy* MaterialProxy = Material->GetRenderProxy();
+
+			for (int32 ViewIndex = 0; ViewIndex < Views.Num(); ViewIndex++)
+			{
+				if (!(VisibilityMap & (1 << ViewIndex)))
+					continue;
+
+				FDynamicMeshBuilder MeshBuilder(Views[ViewIndex]->GetFeatureLevel());
+				MeshBuilder.AddVertices(Vertices);
+				MeshBuilder.AddTriangles(Indices);
+				MeshBuilder.GetMesh(GetLocalToWorld(), MaterialProxy, GetDepthPriorityGroup(Views[ViewIndex]), false,
+				                    false, ViewIndex, Collector);
+			}
+		}
+
+		virtual FPrimitiveViewRelevance GetViewRelevance(const FSceneView* View) const override
+		{
+			FPrimitiveViewRelevance Result;
+			Result.bDrawRelevance = IsShown(View);
+			Result.bShadowRelevance = false;
+			Result.bDynamicRelevance = true;
+			Result.bRenderInMainPass = ShouldRenderInMainPass();
+			Result.bEditorPrimitiveRelevance = UseEditorCompositing(View);
+			MaterialRelevance.SetPrimitiveViewRelevance(Result);
+			return Result;
+		}
+
+		virtual SIZE_T GetTypeHash() const override
+		{
+			static size_t UniquePointer;
+			return reinterpret_cast<size_t>(&UniquePointer);
+		}
+
+		virtual uint32 GetMemoryFootprint() const override
+		{
+			return sizeof(*this) + GetAllocatedSize() + Indices.GetAllocatedSize() + Vertices.GetAllocatedSize();
+		}
+
+	private:
+		void SetVertex(const int32 Index, const FVector3f& Position, const FVector3f& Normal, const FVector3f& Tangent)
+		{
+			FDynamicMeshVertex& Vertex = Vertices[Index];
+			Vertex.Position = Position;
+			Vertex.SetTangents(Tangent, Normal ^ Tangent, Normal);
+		}
+
+		// Writes positions and tangents of every vertex, once per joint update and not per view.
+		void BuildVertices(const FFSHandWireframeJoints& Joints)
+		{
+			int32 Vertex = 0;
+
+			for (const TPair<uint8, uint8>& Segment : Topology.Segments)
+			{
+				const FVector3f Start = Joints.Locations[Segment.Key];
+				const FVector3f End = Joints.Locations[Segment.Value];
+				const FVector3f Direction = (End - Start).GetSafeNormal(UE_SMALL_NUMBER, FVector3f::ForwardVector);
+				const FVector3f Up = FMath::Abs(Direction.Z) < 0.9f ? FVector3f::UpVector : FVector3f::ForwardVector;
+				const FVector3f U = (Direction ^ Up).GetSafeNormal();
+				const FVector3f V = Direction ^ U;
+				const FVector3f Offsets[SegmentSides] = {U, V, -U, -V};
+
+				for (int32 Side = 0; Side < SegmentSides; Side++)
+				{
+					SetVertex(Vertex + Side, Start + Offsets[Side] * Radius, Offsets[Side], Direction);
+					SetVertex(Vertex + SegmentSides + Side, End + Offsets[Side] * Radius, Offsets[Side], Direction);
+				}
+
+				Vertex += SegmentVertexCount;
+			}
+
+			static const FVector3f Axes[JointVertexCount] =
+			{
+				FVector3f::ForwardVector, FVector3f::BackwardVector,
+				FVector3f::RightVector, FVector3f::LeftVector,
+				FVector3f::UpVector, FVector3f::DownVector
+			};
+
+			for (const uint8 Joint : Topology.Joints)
+			{
+				const FVector3f Center = Joints.Locations[Joint];
+				const float JointRadius = Joints.Radii[Joint];
+
+				for (int32 Axis = 0; Axis < JointVertexCount; Axis++)
+				{
+					const FVector3f& Tangent = Axes[(Axis + 2) % JointVertexCount];
+					SetVertex(Vertex + Axis, Center + Axes[Axis] * JointRadius, Axes[Axis], Tangent);
+				}
+
+				Vertex += JointVertexCount;
+			}
+		}
+
+		FWireframeTopology Topology;
+		float Radius;
+		const UMaterialInterface* Material;
+		FMaterialRelevance MaterialRelevance;
+		// Built once per style change.
+		TArray<uint32> Indices;
+		// Render thread only
+		TArray<FDynamicMeshVertex> Vertices;
+	};
+}
+
+UFSHandWireframeComponent::UFSHandWireframeComponent()
+{
+	bHasJoints = false;
+	WireframeColor = FColor::Blue;
+	WireframeThickness = 0.35f;
+	bRenderWireframePalm = false;
+	bRenderWireframeBones = false;
+
+	// Joints are sent in world space relative to the palm, the parent transform is ignored.
+	SetUsingAbsoluteLocation(true);
+	SetUsingAbsoluteRotation(true);
+	SetUsingAbsoluteScale(true);
+	SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetGenerateOverlapEvents(false);
+	CastShadow = false;
+	bUseAsOccluder = false;
+}
+
+void UFSHandWireframeComponent::SetWireframeStyle(const FColor InColor, const float InThickness,
+                                                  const bool bInRenderPalm, const bool bInRenderBones)
+{
+	if (WireframeColor == InColor && WireframeThickness == InThickness &&
+		bRenderWireframePalm == bInRenderPalm && bRenderWireframeBones == bInRenderBones)
+		return;
+
+	WireframeColor = InColor;
+	WireframeThickness = InThickness;
+	bRenderWireframePalm = bInRenderPalm;
+	bRenderWireframeBones = bInRenderBones;
+	MarkRenderStateDirty();
+}
+
+void UFSHandWireframeComponent::UpdatePose(const FFSHandPoseSnapshot& Pose)
+{
+	const FVector Origin = Pose.Locations[FSHandSkeleton::Palm];
+
+	for (int32 i = 0; i < FSHandSkeleton::KeypointCount; i++)
+	{
+		Joints.Locations[i] = FVector3f(Pose.Locations[i] - Origin);
+		Joints.Radii[i] = Pose.Radii[i];
+	}
+
+	bHasJoints = true;
+
+	// Also updates the bounds.
+	SetWorldLocationAndRotation(Origin, FQuat::Identity);
+	UpdateBounds();
+	MarkRenderTransformDirty();
+	MarkRenderDynamicDataDirty();
+}
+
+FPrimitiveSceneProxy* UFSHandWireframeComponent::CreateSceneProxy()
+{
+	return new FFSHandWireframeSceneProxy(this, Joints);
+}
+
+FBoxSphereBounds UFSHandWireframeComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	if (!bHasJoints)
+		return FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.0f);
+
+	FBox Box(ForceInit);
+	float MaxRadius = WireframeThickness;
+
+	for (int32 i = 0; i < FSHandSkeleton::KeypointCount; i++)
+	{
+		Box += FVector(Joints.Locations[i]);
+		MaxRadius = FMath::Max(MaxRadius, Joints.Radii[i]);
+	}
+
+	return FBoxSphereBounds(Box.ExpandBy(MaxRadius)).TransformBy(LocalToWorld);
+}
+
+UMaterialInterface* UFSHandWireframeComponent::GetMaterial(int32 ElementIndex) const
+{
+	UMaterialInterface* Material = Super::GetMaterial(ElementIndex);
+	return Material != nullptr ? Material : GEngine->VertexColorMaterial.Get();
+}
+
+void UFSHandWireframeComponent::SendRenderDynamicData_Concurrent()
+{
+	Super::SendRenderDynamicData_Concurrent();
+
+	if (SceneProxy == nullptr)
+		return;
+
+	ENQUEUE_RENDER_COMMAND(FSHandWireframeUpdate)(
+		[Proxy = static_cast<FFSHandWireframeSceneProxy*>(SceneProxy), Data = Joints](FRHICommandListImmediate&)
+		{
+			Proxy->SetJoints_RenderThread(Data);
+		});
+}
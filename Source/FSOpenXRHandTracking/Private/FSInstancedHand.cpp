@@ -11,7 +11,58 @@
 #include "OculusXRInputFunctionLibrary.h"
 #endif
 #include "Components/PoseableMeshComponent.h"
+#include "Engine/World.h"
 #include "Kismet/GameplayStatics.h"
+#include "FSHandSkeleton.h"
+#include "FSHandTrackingSubsystem.h"
+#include "FSHandInstanceRenderer.h"
+#include "FSHandLateLatchViewExtension.h"
+#include "FSHandWireframeComponent.h"
+#include "FSSkeletonBinding.h"
+#include "FSHandTrackingStats.h"
+#include "Misc/ScopeExit.h"
+
+namespace
+{
+	// About 0.1 degree, rotations of a static hand are considered unchanged below it.
+	constexpr float PoseRotationTolerance = 1.0e-3f;
+}
+
+#if WITH_METAXR
+namespace
+{
+	// OpenXR keypoint to OculusXR bone remap, indexed by EHandKeypoint.
+	constexpr uint8 OculusBones[FSHandSkeleton::KeypointCount] =
+	{
+		static_cast<uint8>(EOculusXRBone::Hand_Start), // Palm
+		static_cast<uint8>(EOculusXRBone::Hand_Start), // Wrist
+		static_cast<uint8>(EOculusXRBone::Thumb_1),
+		static_cast<uint8>(EOculusXRBone::Thumb_2),
+		static_cast<uint8>(EOculusXRBone::Thumb_3),
+		static_cast<uint8>(EOculusXRBone::Thumb_Tip),
+		static_cast<uint8>(EOculusXRBone::Index_1), // Index Metacarpal
+		static_cast<uint8>(EOculusXRBone::Index_1),
+		static_cast<uint8>(EOculusXRBone::Index_2),
+		static_cast<uint8>(EOculusXRBone::Index_3),
+		static_cast<uint8>(EOculusXRBone::Index_Tip),
+		static_cast<uint8>(EOculusXRBone::Middle_1), // Middle Metacarpal
+		static_cast<uint8>(EOculusXRBone::Middle_1),
+		static_cast<uint8>(EOculusXRBone::Middle_2),
+		static_cast<uint8>(EOculusXRBone::Middle_3),
+		static_cast<uint8>(EOculusXRBone::Middle_Tip),
+		static_cast<uint8>(EOculusXRBone::Ring_1), // Ring Metacarpal
+		static_cast<uint8>(EOculusXRBone::Ring_1),
+		static_cast<uint8>(EOculusXRBone::Ring_2),
+		static_cast<uint8>(EOculusXRBone::Ring_3),
+		static_cast<uint8>(EOculusXRBone::Ring_Tip),
+		static_cast<uint8>(EOculusXRBone::Pinky_0),
+		static_cast<uint8>(EOculusXRBone::Pinky_1),
+		static_cast<uint8>(EOculusXRBone::Pinky_2),
+		static_cast<uint8>(EOculusXRBone::Pinky_3),
+		static_cast<uint8>(EOculusXRBone::Pinky_Tip)
+	};
+}
+#endif
 
 UFSInstancedHand::UFSInstancedHand()
 {
@@ -20,6 +71,9 @@ UFSInstancedHand::UFSInstancedHand()
 	bLeftHand = false;
 	HandRendering = EFSOpenXRHandRendering::Both;
 	PinchThreshold = 1.5f;
+	PinchReleaseThreshold = 2.0f;
+	PinchStrengthDistance = 6.0f;
+	bInjectPinchStrength = false;
 	BoneScale = 0.015f;
 	WireframeColor = FColor::Blue;
 	WireframeThickness = 0.35f;
@@ -31,11 +85,42 @@ UFSInstancedHand::UFSInstancedHand()
 	HandPointerLocationSpeed = 8.0f;
 	HandPointerRotationSpeed = 2.0f;
 	HandPointerDepth = 0;
+	bTraceHandRay = false;
+	HandRayLength = 500.0f;
+	HandRayChannel = ECC_Visibility;
+	HandRayReuseDistance = 0.5f;
+	HandRayReuseAngle = 0.5f;
+	TracedRayStart = FVector::ZeroVector;
+	TracedRayDirection = FVector::ForwardVector;
+	bHasTracedRay = false;
+	bHandRayHit = false;
+	HandRayDelegate.BindUObject(this, &UFSInstancedHand::OnHandRayTraced);
 	bHideHand = false;
 	bHideHandPointerWhenNotTracked = false;
-	BoneLocations.Init(FVector::ZeroVector, EHandKeypointCount);
-	BoneRotations.Init(FRotator::ZeroRotator, EHandKeypointCount);
-	BoneRelativeRotations.Init(FRotator::ZeroRotator, EHandKeypointCount);
+	bPersistentInstances = false;
+	bAsyncProcessing = false;
+	bKeepPoseHistory = false;
+	bMonitorTrackingQuality = false;
+	SubmittedTime = 0.0;
+	bEnableCollision = false;
+	CollisionStaticThreshold = 0.1f;
+	PinchMask = 0;
+	InjectedPinchMask = 0;
+	UpdateMode = EFSOpenXRHandUpdateMode::Manual;
+	bInstancesVisible = false;
+	SharedBlock = INDEX_NONE;
+	bUseSharedRenderer = false;
+	SharedRendererColor = FLinearColor::White;
+	bPoseApplied = false;
+	bAppliedPersistentInstances = false;
+	bAppliedSharedRenderer = false;
+	bPointerSettled = false;
+	PoseChangeThreshold = 0.01f;
+	DetailLevel = EFSOpenXRHandDetail::Full;
+	InstanceTransforms.Init(FTransform(FQuat::Identity, FVector::ZeroVector, FVector::ZeroVector), EHandKeypointCount);
+
+	for (FTransform& Transform : AppliedTransforms)
+		Transform = InstanceTransforms[0];
 
 	// Use the default Cube by default
 	const auto MeshAsset =
@@ -44,8 +129,60 @@ UFSInstancedHand::UFSInstancedHand()
 	if (MeshAsset.Object != nullptr)
 		UStaticMeshComponent::SetStaticMesh(MeshAsset.Object);
 
-	constexpr int InputActionCount = static_cast<int>(EFSOpenXRPinchFingers::Little) + 1;
-	InputActions.Init(nullptr, InputActionCount); // 4 Pinchable fingers.
+	for (float& Value : InjectedPinchValues)
+		Value = 0.0f;
+
+	for (float& Strength : PinchStrengths)
+		Strength = 0.0f;
+}
+
+void UFSInstancedHand::OnRegister()
+{
+	Super::OnRegister();
+
+	const UWorld* World = GetWorld();
+
+	if (World != nullptr && World->IsGameWorld())
+	{
+		if (UFSHandTrackingSubsystem* Subsystem = World->GetSubsystem<UFSHandTrackingSubsystem>())
+		{
+			Subsystem->RegisterHand(this);
+			TrackingSubsystem = Subsystem;
+		}
+	}
+}
+
+void UFSInstancedHand::OnUnregister()
+{
+	ReleaseSharedBlock();
+
+	if (UFSHandTrackingSubsystem* Subsystem = TrackingSubsystem.Get())
+		Subsystem->UnregisterHand(this);
+
+	TrackingSubsystem.Reset();
+	ReleasePinchInputs();
+	HandRayTrace = FTraceHandle();
+	bHasTracedRay = false;
+	SetHandRayHit(nullptr);
+	StopRecording();
+	StopArchiving();
+
+	if (Pipeline.IsValid())
+	{
+		if (const TSharedPtr<FFSHandLateLatchViewExtension, ESPMode::ThreadSafe> LateLatch =
+			FFSHandLateLatchViewExtension::Get())
+			LateLatch->Unregister(Pipeline.ToSharedRef());
+
+		Pipeline.Reset();
+	}
+
+	if (WireframeComponent != nullptr)
+	{
+		WireframeComponent->DestroyComponent();
+		WireframeComponent = nullptr;
+	}
+
+	Super::OnUnregister();
 }
 
 FTransform UFSInstancedHand::GetHandTransform() const
@@ -55,12 +192,64 @@ FTransform UFSInstancedHand::GetHandTransform() const
 
 bool UFSInstancedHand::UpdateHand(const FXRMotionControllerData& InData, const float DeltaTime)
 {
-	ClearInstances();
+	ProcessHand(InData);
+	return ApplyHand(InData, DeltaTime);
+}
+
+void UFSInstancedHand::SubmitHandData(const FXRMotionControllerData& InData)
+{
+	SubmittedData = InData;
+	SubmittedTime = FPlatformTime::Seconds();
+}
+
+void UFSInstancedHand::ProcessHand(const FXRMotionControllerData& InData)
+{
+	FS_HAND_TRACKING_SCOPE(ProcessHand);
+
+	FFSHandProcessSettings Settings;
+	Settings.PinchThreshold = PinchThreshold;
+	Settings.PinchReleaseThreshold = PinchReleaseThreshold;
+	Settings.PinchStrengthDistance = PinchStrengthDistance;
+	Settings.bComputeRelativeRotations = bComputeRelativeRotations && DetailLevel == EFSOpenXRHandDetail::Full;
+	Settings.Filter = FilterSettings;
+
+	if (Pipeline.IsValid())
+		Pipeline->Submit(InData, Settings);
+	else
+		FFSHandPosePipeline::ProcessPose(InData, Settings, FPlatformTime::Seconds(), ProcessState, ProcessedPose);
+}
+
+bool UFSInstancedHand::ApplyHand(const FXRMotionControllerData& InData, const float DeltaTime)
+{
+	FS_HAND_TRACKING_SCOPE(ApplyHand);
+
+	if (Recorder.IsValid())
+		Recorder->Record(InData);
+
+	if (ArchiveWriter.IsValid())
+		ArchiveWriter->Record(InData);
+
+	// In async mode this is the latest complete pose published by the worker.
+	const FFSHandPoseSnapshot& Pose = Pipeline.IsValid() ? Pipeline->ReadLatest() : ProcessedPose;
+	ConsumePose(Pose);
 
-	bHandTracked = InData.bValid;
+	// Pose stays valid until the pipeline is created or destroyed.
+	ON_SCOPE_EXIT
+	{
+		UpdatePipeline();
+	};
+
+	if (!bUseSharedRenderer)
+		ReleaseSharedBlock();
+
+	const bool bPoseChanged = bHandTracked && UpdateAppliedPose();
+
+	if (!bPersistentInstances && !bUseSharedRenderer && (bPoseChanged || !bHandTracked))
+		ClearInstances();
 
 	if (bHandTracked != bPreviousHandTracked)
 	{
+		FS_HAND_TRACKING_COUNT(TrackingFlips, 1);
 		bPreviousHandTracked = bHandTracked;
 
 		// Enable/Disable the hand ray if needed.
@@ -68,162 +257,341 @@ bool UFSInstancedHand::UpdateHand(const FXRMotionControllerData& InData, const f
 			PointerContainer->SetVisibility(bHandTracked, true);
 
 		HandTrackingEnableChanged.Broadcast(bLeftHand, bHandTracked);
-	}
 
-	if (!bHandTracked) return false;
-
-	// Render wireframe if needed
-	if (!bHideHand && HandRendering == EFSOpenXRHandRendering::Both || HandRendering ==
-		EFSOpenXRHandRendering::Wireframe)
-	{
-		RenderFinger(InData, EHandKeypoint::ThumbMetacarpal, EHandKeypoint::ThumbTip);
-		RenderFinger(InData, EHandKeypoint::IndexMetacarpal, EHandKeypoint::IndexTip);
-		RenderFinger(InData, EHandKeypoint::MiddleMetacarpal, EHandKeypoint::MiddleTip);
-		RenderFinger(InData, EHandKeypoint::RingMetacarpal, EHandKeypoint::RingTip);
-		RenderFinger(InData, EHandKeypoint::LittleMetacarpal, EHandKeypoint::LittleTip);
+		if (UFSHandTrackingSubsystem* Subsystem = TrackingSubsystem.Get())
+			Subsystem->OnHandTrackingChanged.Broadcast(this, bHandTracked);
 	}
 
-	FTransform BoneTransform;
+	if (bMonitorTrackingQuality != TrackingQuality.IsValid())
+		TrackingQuality = bMonitorTrackingQuality ? MakeUnique<FFSHandTrackingQuality>() : nullptr;
 
-	constexpr uint8 PalmIndex = static_cast<uint8>(EHandKeypoint::Palm);
+	if (TrackingQuality.IsValid())
+	{
+		// Remote hands are as old as their submission.
+		const double SampleTime = UpdateMode == EFSOpenXRHandUpdateMode::Submitted
+			                          ? FMath::Min(SubmittedTime, Pose.SampleTime)
+			                          : Pose.SampleTime;
+		TrackingQuality->Update(FPlatformTime::Seconds(), bHandTracked, Pose.Locations, SampleTime);
+	}
 
-	// Populate array data and add instances.
-	for (int i = 0; i < InData.HandKeyPositions.Num(); i++)
+	if (!bHandTracked)
 	{
-		BoneLocations[i] = InData.HandKeyPositions[i];
-		BoneRotations[i] = InData.HandKeyRotations[i].Rotator();
+		ReleasePinchInputs();
+		UpdateWireframe(nullptr, false);
+		UpdateCollision(nullptr);
+		bPoseApplied = false;
 
-		if (i == PalmIndex)
-		{
-			CurrentHandTransform.SetLocation(InData.HandKeyPositions[i]);
-			CurrentHandTransform.SetRotation(InData.HandKeyRotations[i]);
-		}
+		if (bUseSharedRenderer)
+			HideSharedInstances();
+		else if (bPersistentInstances)
+			HideInstancePool();
 
-		BoneTransform.SetLocation(InData.HandKeyPositions[i]);
-		BoneTransform.SetRotation(InData.HandKeyRotations[i]);
+		return false;
+	}
 
-		const float BoneScaleFactor = InData.HandKeyRadii[i] * BoneScale;
-		FVector BoneScale3D = FVector(BoneScaleFactor, BoneScaleFactor, BoneScaleFactor);
-		BoneTransform.SetScale3D(BoneScale3D);
+	// Render wireframe if needed
+	UpdateWireframe(&Pose, bPoseChanged);
 
-		bool bDisplayBone = !bHideHand;
+	UpdateCollision(DetailLevel == EFSOpenXRHandDetail::Full ? &Pose : nullptr);
 
-		if (bDisplayBone && bOnlyDisplayTips)
+	// Instances
+	if (!bPoseChanged)
+	{
+		FS_HAND_TRACKING_COUNT(UnchangedPoses, 1);
+	}
+	else if (bUseSharedRenderer)
+	{
+		UpdateSharedInstances();
+	}
+	else if (bPersistentInstances)
+	{
+		UpdateInstancePool();
+	}
+	else
+	{
+		FS_HAND_TRACKING_SCOPE(Instances);
+		int32 InstanceCount = 0;
+
+		for (const FTransform& InstanceTransform : InstanceTransforms)
 		{
-			bDisplayBone =
-				i == static_cast<uint8>(EHandKeypoint::ThumbTip) ||
-				i == static_cast<uint8>(EHandKeypoint::IndexTip) ||
-				i == static_cast<uint8>(EHandKeypoint::MiddleTip) ||
-				i == static_cast<uint8>(EHandKeypoint::RingTip) ||
-				i == static_cast<uint8>(EHandKeypoint::LittleTip);
+			if (!InstanceTransform.GetScale3D().IsZero())
+			{
+				AddInstance(InstanceTransform, true);
+				InstanceCount++;
+			}
 		}
 
-		if (bDisplayBone)
-			AddInstance(BoneTransform, true);
+		FS_HAND_TRACKING_COUNT(InstancesTouched, InstanceCount);
 	}
 
-	// Broadcast Pinch Events
-	for (int i = 0; i < InputActions.Num(); i++)
-	{
-		if (InputActions[i] == nullptr) continue;
-		const EFSOpenXRPinchFingers Finger = static_cast<EFSOpenXRPinchFingers>(i);
+	// Pinch inputs are only injected on state transitions
+	InjectPinchInputs();
 
-		if (IsPinching(Finger))
-			OverrideInputWithAction(InputActions[i], 1.0f);
-	}
-
-	// Update the Hand Pointer if needed
-	if (bUpdateHandPointer && PointerContainer != nullptr)
+	// Update the Hand Pointer if needed, a static hand only moves it until it reaches the palm.
+	if (bUpdateHandPointer && PointerContainer != nullptr && (bPoseChanged || !bPointerSettled))
 	{
+		FS_HAND_TRACKING_SCOPE(HandPointer);
+
 		// Get the current pointer transform
 		const FVector PointerLocation = PointerContainer->GetComponentLocation();
 		const FRotator PointerRotation = PointerContainer->GetComponentRotation();
 
 		// Get the target pointer transform and add an angle to the ray
-		const FVector PalmLocation = BoneLocations[PalmIndex];
-		FRotator PalmRotation = BoneRotations[PalmIndex];
+		const FVector PalmLocation = JointPose.Locations[FSHandSkeleton::Palm];
+		FRotator PalmRotation = JointPose.Rotations[FSHandSkeleton::Palm].Rotator();
 		PalmRotation.Pitch += HandPointerAngleFromPalm;
 
-		// Move the container
-		const FVector TargetLocation = FMath::Lerp(PointerLocation, PalmLocation, DeltaTime * HandPointerLocationSpeed);
-		const FRotator TargetRotation =
-			FMath::Lerp(PointerRotation, PalmRotation, DeltaTime * HandPointerRotationSpeed);
+		// Move the container, exponential smoothing gives the same result at any frame rate
+		const float LocationAlpha = 1.0f - FMath::Exp(-HandPointerLocationSpeed * DeltaTime);
+		const float RotationAlpha = 1.0f - FMath::Exp(-HandPointerRotationSpeed * DeltaTime);
+		const FVector TargetLocation = FMath::Lerp(PointerLocation, PalmLocation, LocationAlpha);
+		const FRotator TargetRotation = FMath::Lerp(PointerRotation, PalmRotation, RotationAlpha);
 		PointerContainer->SetWorldLocationAndRotation(TargetLocation, TargetRotation);
+		bPointerSettled = TargetLocation.Equals(PalmLocation, PoseChangeThreshold) &&
+			TargetRotation.Equals(PalmRotation, 0.1f);
 	}
 
-#if !WITH_METAXR
-	if (bComputeRelativeRotations)
+	return true;
+}
+
+void UFSInstancedHand::ConsumePose(const FFSHandPoseSnapshot& Pose)
+{
+	bHandTracked = Pose.bValid;
+
+	if (bKeepPoseHistory != PoseHistory.IsValid())
+		PoseHistory = bKeepPoseHistory ? MakeUnique<FFSHandPoseHistory>() : nullptr;
+
+	if (!bHandTracked)
 	{
-		for (int i = 0; i < InData.HandKeyRotations.Num(); ++i)
-		{
-			const int ParentIndex = GetParentIndex(static_cast<EHandKeypoint>(i));
-			if (ParentIndex != INDEX_NONE)
-			{
-				FQuat ParentQuat = InData.HandKeyRotations[ParentIndex];
-				FQuat BoneQuat = InData.HandKeyRotations[i];
-				FQuat RelativeQuat = ParentQuat.Inverse() * BoneQuat;
-				BoneRelativeRotations[i] = RelativeQuat.Rotator();
-			}
-			else
-			{
-				BoneRelativeRotations[i] = InData.HandKeyRotations[i].Rotator();
-			}
-		}
+		if (PoseHistory.IsValid())
+			PoseHistory->Reset();
+
+		PinchMask = 0;
+
+		for (float& Strength : PinchStrengths)
+			Strength = 0.0f;
+
+		return;
 	}
-#endif
 
-	return true;
+	FTransform BoneTransform;
+
+	// Populate array data and compute instance transforms.
+	for (int i = 0; i < FSHandSkeleton::KeypointCount; i++)
+	{
+		JointPose.Locations[i] = Pose.Locations[i];
+		JointPose.Rotations[i] = Pose.Rotations[i];
+
+		BoneTransform.SetLocation(Pose.Locations[i]);
+		BoneTransform.SetRotation(Pose.Rotations[i]);
+
+		bool bDisplayBone = !bHideHand;
+
+		if (bDisplayBone && DetailLevel == EFSOpenXRHandDetail::Minimal)
+			bDisplayBone = i == FSHandSkeleton::Palm;
+		else if (bDisplayBone && (bOnlyDisplayTips || DetailLevel == EFSOpenXRHandDetail::Reduced))
+			bDisplayBone = FSHandSkeleton::IsTip(i);
+
+		// Hidden bones are masked in place so the pool never reallocates.
+		const float BoneScaleFactor = bDisplayBone ? Pose.Radii[i] * BoneScale : 0.0f;
+		BoneTransform.SetScale3D(FVector(BoneScaleFactor));
+
+		InstanceTransforms[i] = BoneTransform;
+	}
+
+	CurrentHandTransform.SetLocation(Pose.Locations[FSHandSkeleton::Palm]);
+	CurrentHandTransform.SetRotation(Pose.Rotations[FSHandSkeleton::Palm]);
+
+	JointPose.RelativeRotations = Pose.RelativeRotations;
+	GestureFeatures = Pose.GestureFeatures;
+	PinchMask = Pose.PinchMask;
+
+	if (bKeepPoseHistory)
+		PoseHistory->Push(Pose.SampleTime, Pose.Locations, Pose.Rotations[FSHandSkeleton::Palm]);
+
+	for (int32 Finger = 0; Finger < FFSPinchDetector::FingerCount; Finger++)
+		PinchStrengths[Finger] = Pose.PinchStrengths[Finger];
+}
+
+bool UFSInstancedHand::UpdateAppliedPose()
+{
+	// Everything is rebuilt after a tracking loss or a change of instance mode.
+	bool bChanged = !bPoseApplied || bAppliedPersistentInstances != bPersistentInstances ||
+		bAppliedSharedRenderer != bUseSharedRenderer;
+	const double ThresholdSquared = FMath::Square(PoseChangeThreshold);
+
+	for (int32 i = 0; i < FSHandSkeleton::KeypointCount && !bChanged; i++)
+	{
+		const FTransform& Transform = InstanceTransforms[i];
+		const FTransform& Applied = AppliedTransforms[i];
+
+		bChanged = FVector::DistSquared(Transform.GetLocation(), Applied.GetLocation()) > ThresholdSquared ||
+			Transform.GetScale3D() != Applied.GetScale3D() ||
+			!Transform.GetRotation().Equals(Applied.GetRotation(), PoseRotationTolerance);
+	}
+
+	if (bChanged)
+	{
+		for (int32 i = 0; i < FSHandSkeleton::KeypointCount; i++)
+			AppliedTransforms[i] = InstanceTransforms[i];
+
+		bPoseApplied = true;
+		bAppliedPersistentInstances = bPersistentInstances;
+		bAppliedSharedRenderer = bUseSharedRenderer;
+	}
+
+	return bChanged;
+}
+
+void UFSInstancedHand::UpdatePipeline()
+{
+	if (bAsyncProcessing == Pipeline.IsValid()) return;
+
+	const TSharedPtr<FFSHandLateLatchViewExtension, ESPMode::ThreadSafe> LateLatch =
+		FFSHandLateLatchViewExtension::Get();
+
+	if (bAsyncProcessing)
+	{
+		Pipeline = MakeShared<FFSHandPosePipeline, ESPMode::ThreadSafe>();
+
+		if (LateLatch.IsValid())
+			LateLatch->Register(Pipeline.ToSharedRef());
+	}
+	else
+	{
+		if (LateLatch.IsValid())
+			LateLatch->Unregister(Pipeline.ToSharedRef());
+
+		Pipeline.Reset();
+	}
+}
+
+void UFSInstancedHand::UpdateInstancePool()
+{
+	FS_HAND_TRACKING_SCOPE(Instances);
+	FS_HAND_TRACKING_COUNT(InstancesTouched, InstanceTransforms.Num());
+
+	// The pool is (re)created only when its size doesn't match, e.g. on the first frame
+	// or after switching from the non persistent mode.
+	if (GetInstanceCount() != InstanceTransforms.Num())
+	{
+		ClearInstances();
+		AddInstances(InstanceTransforms, false, true);
+	}
+	else
+	{
+		BatchUpdateInstancesTransforms(0, InstanceTransforms, true, true);
+	}
+
+	bInstancesVisible = true;
+}
+
+void UFSInstancedHand::HideInstancePool()
+{
+	if (!bInstancesVisible) return;
+
+	for (FTransform& InstanceTransform : InstanceTransforms)
+		InstanceTransform.SetScale3D(FVector::ZeroVector);
+
+	UpdateInstancePool();
+	bInstancesVisible = false;
+}
+
+void UFSInstancedHand::UpdateSharedInstances()
+{
+	FS_HAND_TRACKING_SCOPE(Instances);
+
+	// Instances left by the other modes.
+	if (GetInstanceCount() > 0)
+		ClearInstances();
+
+	UFSHandInstanceRenderer* Renderer = SharedRenderer.Get();
+
+	// The mesh or the material of the hand changed.
+	if (Renderer != nullptr &&
+		(Renderer->GetStaticMesh() != GetStaticMesh() || Renderer->GetMaterial(0) != GetMaterial(0)))
+	{
+		ReleaseSharedBlock();
+		Renderer = nullptr;
+	}
+
+	if (Renderer == nullptr)
+	{
+		UFSHandTrackingSubsystem* Subsystem = TrackingSubsystem.Get();
+		Renderer = Subsystem != nullptr ? Subsystem->GetSharedRenderer(GetStaticMesh(), GetMaterial(0)) : nullptr;
+
+		if (Renderer == nullptr) return;
+
+		SharedRenderer = Renderer;
+		SharedBlock = Renderer->AllocateBlock();
+	}
+
+	Renderer->UpdateBlock(SharedBlock, InstanceTransforms, SharedRendererColor);
+	bInstancesVisible = true;
+}
+
+void UFSInstancedHand::HideSharedInstances()
+{
+	if (!bInstancesVisible) return;
+
+	if (UFSHandInstanceRenderer* Renderer = SharedRenderer.Get())
+		Renderer->HideBlock(SharedBlock);
+
+	bInstancesVisible = false;
+}
+
+void UFSInstancedHand::ReleaseSharedBlock()
+{
+	if (SharedBlock == INDEX_NONE) return;
+
+	if (UFSHandInstanceRenderer* Renderer = SharedRenderer.Get())
+		Renderer->FreeBlock(SharedBlock);
+
+	SharedRenderer.Reset();
+	SharedBlock = INDEX_NONE;
+	bInstancesVisible = false;
 }
 
 void UFSInstancedHand::GetDataFromSkeleton(UPoseableMeshComponent* Target, const bool bLeft,
                                            FXRMotionControllerData& OutData)
 {
+	FS_HAND_TRACKING_SCOPE(GetDataFromSkeleton);
+
 #if WITH_METAXR
 	const FTransform Pose = UOculusXRInputFunctionLibrary::GetPointerPose(
 		bLeft ? EOculusXRHandType::HandLeft : EOculusXRHandType::HandRight);
 
+	static const FName LeftDeviceName(TEXT("OculusXRLeftHand"));
+	static const FName RightDeviceName(TEXT("OculusXRRightHand"));
+
 	OutData.bValid = Target->IsVisible();
 	OutData.HandIndex = bLeft ? EControllerHand::Left : EControllerHand::Right;
 	OutData.AimPosition = Pose.GetLocation();
 	OutData.AimRotation = Pose.GetRotation();
-	OutData.DeviceName = bLeft ? "OculusXRLeftHand" : "OculusXRRightHand";
+	OutData.DeviceName = bLeft ? LeftDeviceName : RightDeviceName;
 	OutData.TrackingStatus = OutData.bValid ? ETrackingStatus::Tracked : ETrackingStatus::NotTracked;
 	OutData.DeviceVisualType = EXRVisualType::Hand;
-	OutData.HandKeyPositions.Empty();
-	OutData.HandKeyRotations.Empty();
-	OutData.HandKeyRadii.Empty();
-
-	EHandKeypoint HandKeyPoint;
-	uint8 BoneIndex;
-	EOculusXRBone Bone;
-	FString BoneName;
-	FName BoneFName;
-	FVector WorldLocation;
-	FRotator WorldRotation;
-
-	for (int i = 0; i < EHandKeypointCount; i++)
-	{
-		HandKeyPoint = static_cast<EHandKeypoint>(i);
-		BoneIndex = GetOculusBone(HandKeyPoint);
-		Bone = static_cast<EOculusXRBone>(BoneIndex);
-		BoneName = UOculusXRInputFunctionLibrary::GetBoneName(Bone);
-		BoneFName = FName(*BoneName);
-
-		WorldLocation = Target->GetBoneLocationByName(BoneFName, EBoneSpaces::WorldSpace);
-		WorldRotation = Target->GetBoneRotationByName(BoneFName, EBoneSpaces::WorldSpace);
-
-		if (HandKeyPoint == EHandKeypoint::Palm)
-		{
-			OutData.PalmPosition = WorldLocation;
-			OutData.PalmRotation = WorldRotation.Quaternion();
-			OutData.GripPosition = WorldLocation;
-			OutData.GripRotation = WorldRotation.Quaternion();
-		}
 
-		OutData.HandKeyPositions.Add(WorldLocation);
-		OutData.HandKeyRotations.Add(WorldRotation.Quaternion());
-		OutData.HandKeyRadii.Add(0.2f);
+	// Bone names are resolved once per skeletal mesh.
+	const FFSSkeletonBinding* Binding = FFSSkeletonBinding::Find(Target, [](const int32 Keypoint)
+	{
+		const EOculusXRBone Bone = static_cast<EOculusXRBone>(GetOculusBone(static_cast<EHandKeypoint>(Keypoint)));
+		return FName(*UOculusXRInputFunctionLibrary::GetBoneName(Bone));
+	});
+
+	if (Binding == nullptr)
+	{
+		OutData.bValid = false;
+		OutData.TrackingStatus = ETrackingStatus::NotTracked;
+		return;
 	}
+
+	Binding->ReadWorldSpace(Target, OutData);
+
+	OutData.PalmPosition = OutData.HandKeyPositions[FSHandSkeleton::Palm];
+	OutData.PalmRotation = OutData.HandKeyRotations[FSHandSkeleton::Palm];
+	OutData.GripPosition = OutData.PalmPosition;
+	OutData.GripRotation = OutData.PalmRotation;
 #endif
 }
 
@@ -232,24 +600,48 @@ bool UFSInstancedHand::IsHandTracked() const
 	return bHandTracked;
 }
 
-bool UFSInstancedHand::IsPinching(const EFSOpenXRPinchFingers Finger) const
+bool UFSInstancedHand::WasHandRecentlyRendered(const float Tolerance) const
 {
-	constexpr uint8 ThumbIndex = static_cast<uint8>(EHandKeypoint::ThumbTip);
-	uint8 OtherIndex = static_cast<uint8>(EHandKeypoint::IndexTip);
+	// The shared renderer is tested as a whole, it's rendered if any of its hands is.
+	const UFSHandInstanceRenderer* Renderer = SharedBlock != INDEX_NONE ? SharedRenderer.Get() : nullptr;
 
-	if (Finger == EFSOpenXRPinchFingers::Middle)
-		OtherIndex = static_cast<uint8>(EHandKeypoint::MiddleTip);
-	else if (Finger == EFSOpenXRPinchFingers::Ring)
-		OtherIndex = static_cast<uint8>(EHandKeypoint::RingTip);
-	else if (Finger == EFSOpenXRPinchFingers::Little)
-		OtherIndex = static_cast<uint8>(EHandKeypoint::LittleTip);
+	return WasRecentlyRendered(Tolerance) || (Renderer != nullptr && Renderer->WasRecentlyRendered(Tolerance)) ||
+		(WireframeComponent != nullptr && WireframeComponent->WasRecentlyRendered(Tolerance));
+}
 
-	return FVector::Dist(BoneLocations[ThumbIndex], BoneLocations[OtherIndex]) <= PinchThreshold;
+bool UFSInstancedHand::IsPinching(const EFSOpenXRPinchFingers Finger) const
+{
+	return (PinchMask & (1 << static_cast<int32>(Finger))) != 0;
+}
+
+float UFSInstancedHand::GetPinchStrength(const EFSOpenXRPinchFingers Finger) const
+{
+	return PinchStrengths[static_cast<int32>(Finger)];
 }
 
 void UFSInstancedHand::RegisterInputAction(const EFSOpenXRPinchFingers Finger, UInputAction* InInputAction)
 {
 	const int Index = static_cast<int>(Finger);
+
+	if (InputActions[Index] == InInputAction) return;
+
+	// Move a running injection to the new action.
+	if ((InjectedPinchMask & (1 << Index)) != 0)
+	{
+		if (UEnhancedInputLocalPlayerSubsystem* Subsystem = GetInputSubsystem())
+		{
+			if (InputActions[Index] != nullptr)
+				Subsystem->StopContinuousInputInjectionForAction(InputActions[Index]);
+
+			if (InInputAction != nullptr)
+			{
+				Subsystem->StartContinuousInputInjectionForAction(
+					InInputAction, FInputActionValue(InjectedPinchValues[Index]), TArray<UInputModifier*>(),
+					TArray<UInputTrigger*>());
+			}
+		}
+	}
+
 	InputActions[Index] = InInputAction;
 }
 
@@ -262,13 +654,13 @@ void UFSInstancedHand::RegisterHandRay(USceneComponent* InRayContainer)
 FRotator UFSInstancedHand::GetBoneRotation(const EHandKeypoint Keypoint) const
 {
 	const int Index = static_cast<int>(Keypoint);
-	return BoneRotations[Index];
+	return JointPose.Rotations[Index].Rotator();
 }
 
 FVector UFSInstancedHand::GetBoneLocation(const EHandKeypoint Keypoint) const
 {
 	const int Index = static_cast<int>(Keypoint);
-	return BoneLocations[Index];
+	return JointPose.Locations[Index];
 }
 
 FRotator UFSInstancedHand::GetBoneRelativeRotation(const EHandKeypoint Keypoint) const
@@ -281,164 +673,267 @@ FRotator UFSInstancedHand::GetBoneRelativeRotation(const EHandKeypoint Keypoint)
 	return BoneQuat.Rotator();
 #else
 	const int Index = static_cast<int>(Keypoint);
-	return BoneRelativeRotations[Index];
+	return JointPose.RelativeRotations.GetQuat(Index).Rotator();
 #endif
 }
 
-void UFSInstancedHand::OverrideInputWithAction(const UInputAction* InInputAction, const float Value) const
+FFSHandQualityStats UFSInstancedHand::GetTrackingQuality(const EFSHandQualityMetric Metric) const
 {
-	const APlayerController* PC = UGameplayStatics::GetPlayerController(GetWorld(), 0);
-	auto* Subsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PC->GetLocalPlayer());
+	return TrackingQuality.IsValid() ? TrackingQuality->GetHistogram(Metric).GetStats() : FFSHandQualityStats();
+}
 
-	Subsystem->InjectInputForAction(
-		InInputAction,
-		FInputActionValue(Value),
-		TArray<UInputModifier*>(),
-		TArray<UInputTrigger*>());
+int32 UFSInstancedHand::GetDropoutCount() const
+{
+	return TrackingQuality.IsValid() ? static_cast<int32>(TrackingQuality->GetDropoutCount()) : 0;
 }
 
-int32 UFSInstancedHand::GetParentIndex(EHandKeypoint Keypoint)
+void UFSInstancedHand::K2_GetAllBoneTransforms(TArray<FTransform>& OutTransforms) const
 {
-	static TMap<EHandKeypoint, EHandKeypoint> ParentMap;
-	if (ParentMap.Num() == 0)
-	{
-		// Thumb
-		ParentMap.Add(EHandKeypoint::ThumbTip, EHandKeypoint::ThumbDistal);
-		ParentMap.Add(EHandKeypoint::ThumbDistal, EHandKeypoint::ThumbProximal);
-		ParentMap.Add(EHandKeypoint::ThumbProximal, EHandKeypoint::ThumbMetacarpal);
+	OutTransforms.SetNumUninitialized(FFSHandJointPose::JointCount, EAllowShrinking::No);
+	GetAllBoneTransforms(OutTransforms);
+}
+
+bool UFSInstancedHand::StartRecording(const FString& Filename)
+{
+	if (!Recorder.IsValid())
+		Recorder = MakeUnique<FFSHandPoseRecorder>();
+
+	return Recorder->Open(Filename);
+}
+
+void UFSInstancedHand::StopRecording()
+{
+	Recorder.Reset();
+}
+
+bool UFSInstancedHand::IsRecording() const
+{
+	return Recorder.IsValid() && Recorder->IsOpen();
+}
+
+bool UFSInstancedHand::StartArchiving(const FString& Filename)
+{
+	if (!ArchiveWriter.IsValid())
+		ArchiveWriter = MakeUnique<FFSHandPoseArchiveWriter>();
+
+	return ArchiveWriter->Open(Filename);
+}
+
+void UFSInstancedHand::StopArchiving()
+{
+	// The writer flushes its last chunk and the index when destroyed.
+	ArchiveWriter.Reset();
+}
+
+bool UFSInstancedHand::IsArchiving() const
+{
+	return ArchiveWriter.IsValid() && ArchiveWriter->IsOpen();
+}
+
+void UFSInstancedHand::InjectPinchInputs()
+{
+	const uint8 PressedMask = PinchMask & ~InjectedPinchMask;
+	const uint8 ReleasedMask = InjectedPinchMask & ~PinchMask;
+	const bool bUpdateStrength = bInjectPinchStrength && PinchMask != 0;
 
-		// Index
-		ParentMap.Add(EHandKeypoint::IndexTip, EHandKeypoint::IndexDistal);
-		ParentMap.Add(EHandKeypoint::IndexDistal, EHandKeypoint::IndexIntermediate);
-		ParentMap.Add(EHandKeypoint::IndexIntermediate, EHandKeypoint::IndexProximal);
-		ParentMap.Add(EHandKeypoint::IndexProximal, EHandKeypoint::IndexMetacarpal);
+	if (PressedMask == 0 && ReleasedMask == 0 && !bUpdateStrength) return;
 
-		// Middle
-		ParentMap.Add(EHandKeypoint::MiddleTip, EHandKeypoint::MiddleDistal);
-		ParentMap.Add(EHandKeypoint::MiddleDistal, EHandKeypoint::MiddleIntermediate);
-		ParentMap.Add(EHandKeypoint::MiddleIntermediate, EHandKeypoint::MiddleProximal);
-		ParentMap.Add(EHandKeypoint::MiddleProximal, EHandKeypoint::MiddleMetacarpal);
+	FS_HAND_TRACKING_SCOPE(InputInjection);
 
-		// Ring
-		ParentMap.Add(EHandKeypoint::RingTip, EHandKeypoint::RingDistal);
-		ParentMap.Add(EHandKeypoint::RingDistal, EHandKeypoint::RingIntermediate);
-		ParentMap.Add(EHandKeypoint::RingIntermediate, EHandKeypoint::RingProximal);
-		ParentMap.Add(EHandKeypoint::RingProximal, EHandKeypoint::RingMetacarpal);
+	UEnhancedInputLocalPlayerSubsystem* Subsystem = GetInputSubsystem();
+	if (Subsystem == nullptr) return;
 
-		// Little
-		ParentMap.Add(EHandKeypoint::LittleTip, EHandKeypoint::LittleDistal);
-		ParentMap.Add(EHandKeypoint::LittleDistal, EHandKeypoint::LittleIntermediate);
-		ParentMap.Add(EHandKeypoint::LittleIntermediate, EHandKeypoint::LittleProximal);
-		ParentMap.Add(EHandKeypoint::LittleProximal, EHandKeypoint::LittleMetacarpal);
+	int32 InjectionCount = 0;
 
-		// Metacarpals to Palm
-		ParentMap.Add(EHandKeypoint::ThumbMetacarpal, EHandKeypoint::Palm);
-		ParentMap.Add(EHandKeypoint::IndexMetacarpal, EHandKeypoint::Palm);
-		ParentMap.Add(EHandKeypoint::MiddleMetacarpal, EHandKeypoint::Palm);
-		ParentMap.Add(EHandKeypoint::RingMetacarpal, EHandKeypoint::Palm);
-		ParentMap.Add(EHandKeypoint::LittleMetacarpal, EHandKeypoint::Palm);
+	// Continuous injections are kept alive by Enhanced Input until they are stopped,
+	// so the subsystem is only touched when something changed.
+	for (int32 Finger = 0; Finger < FFSPinchDetector::FingerCount; ++Finger)
+	{
+		const UInputAction* Action = InputActions[Finger];
+		if (Action == nullptr) continue;
+
+		const uint8 Bit = 1 << Finger;
+		const float Value = bInjectPinchStrength ? PinchStrengths[Finger] : 1.0f;
 
-		// Wrist to Palm
-		ParentMap.Add(EHandKeypoint::Palm, EHandKeypoint::Wrist);
+		if ((PressedMask & Bit) != 0)
+		{
+			Subsystem->StartContinuousInputInjectionForAction(Action, FInputActionValue(Value),
+			                                                  TArray<UInputModifier*>(), TArray<UInputTrigger*>());
+			InjectedPinchValues[Finger] = Value;
+			InjectionCount++;
+		}
+		else if ((ReleasedMask & Bit) != 0)
+		{
+			Subsystem->StopContinuousInputInjectionForAction(Action);
+			InjectedPinchValues[Finger] = 0.0f;
+			InjectionCount++;
+		}
+		else if (bUpdateStrength && (PinchMask & Bit) != 0 &&
+			!FMath::IsNearlyEqual(Value, InjectedPinchValues[Finger], 0.01f))
+		{
+			Subsystem->UpdateValueOfContinuousInputInjectionForAction(Action, FInputActionValue(Value));
+			InjectedPinchValues[Finger] = Value;
+			InjectionCount++;
+		}
 	}
 
-	if (ParentMap.Contains(Keypoint))
+	FS_HAND_TRACKING_COUNT(InputInjections, InjectionCount);
+	InjectedPinchMask = PinchMask;
+}
+
+void UFSInstancedHand::ReleasePinchInputs()
+{
+	ProcessState.Reset();
+	PinchMask = 0;
+
+	for (float& Strength : PinchStrengths)
+		Strength = 0.0f;
+
+	if (InjectedPinchMask != 0)
+		InjectPinchInputs();
+}
+
+UEnhancedInputLocalPlayerSubsystem* UFSInstancedHand::GetInputSubsystem()
+{
+	if (!InputSubsystem.IsValid())
 	{
-		return static_cast<int32>(ParentMap[Keypoint]);
+		const APlayerController* PC = UGameplayStatics::GetPlayerController(GetWorld(), 0);
+
+		if (PC != nullptr)
+			InputSubsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PC->GetLocalPlayer());
 	}
-	return INDEX_NONE;
+
+	return InputSubsystem.Get();
 }
 
 uint8 UFSInstancedHand::GetOculusBone(EHandKeypoint Keypoint)
 {
 #if WITH_METAXR
-	if (Keypoint == EHandKeypoint::Wrist || Keypoint == EHandKeypoint::Palm)
-		return static_cast<uint8>(EOculusXRBone::Hand_Start);
-
-	if (Keypoint == EHandKeypoint::ThumbMetacarpal)
-		return static_cast<uint8>(EOculusXRBone::Thumb_1);
-	if (Keypoint == EHandKeypoint::ThumbProximal)
-		return static_cast<uint8>(EOculusXRBone::Thumb_2);
-	if (Keypoint == EHandKeypoint::ThumbDistal)
-		return static_cast<uint8>(EOculusXRBone::Thumb_3);
-	if (Keypoint == EHandKeypoint::ThumbTip)
-		return static_cast<uint8>(EOculusXRBone::Thumb_Tip);
-
-	if (Keypoint == EHandKeypoint::IndexProximal || Keypoint == EHandKeypoint::IndexMetacarpal)
-		return static_cast<uint8>(EOculusXRBone::Index_1);
-	if (Keypoint == EHandKeypoint::IndexIntermediate)
-		return static_cast<uint8>(EOculusXRBone::Index_2);
-	if (Keypoint == EHandKeypoint::IndexDistal)
-		return static_cast<uint8>(EOculusXRBone::Index_3);
-	if (Keypoint == EHandKeypoint::IndexTip)
-		return static_cast<uint8>(EOculusXRBone::Index_Tip);
-
-	if (Keypoint == EHandKeypoint::MiddleProximal || Keypoint == EHandKeypoint::MiddleMetacarpal)
-		return static_cast<uint8>(EOculusXRBone::Middle_1);
-	if (Keypoint == EHandKeypoint::MiddleIntermediate)
-		return static_cast<uint8>(EOculusXRBone::Middle_2);
-	if (Keypoint == EHandKeypoint::MiddleDistal)
-		return static_cast<uint8>(EOculusXRBone::Middle_3);
-	if (Keypoint == EHandKeypoint::MiddleTip)
-		return static_cast<uint8>(EOculusXRBone::Middle_Tip);
-
-	if (Keypoint == EHandKeypoint::RingProximal || Keypoint == EHandKeypoint::RingMetacarpal)
-		return static_cast<uint8>(EOculusXRBone::Ring_1);
-	if (Keypoint == EHandKeypoint::RingIntermediate)
-		return static_cast<uint8>(EOculusXRBone::Ring_2);
-	if (Keypoint == EHandKeypoint::RingDistal)
-		return static_cast<uint8>(EOculusXRBone::Ring_3);
-	if (Keypoint == EHandKeypoint::RingTip)
-		return static_cast<uint8>(EOculusXRBone::Ring_Tip);
-
-	if (Keypoint == EHandKeypoint::LittleMetacarpal)
-		return static_cast<uint8>(EOculusXRBone::Pinky_0);
-	if (Keypoint == EHandKeypoint::LittleProximal)
-		return static_cast<uint8>(EOculusXRBone::Pinky_1);
-	if (Keypoint == EHandKeypoint::LittleIntermediate)
-		return static_cast<uint8>(EOculusXRBone::Pinky_2);
-	if (Keypoint == EHandKeypoint::LittleDistal)
-		return static_cast<uint8>(EOculusXRBone::Pinky_3);
-	if (Keypoint == EHandKeypoint::LittleTip)
-		return static_cast<uint8>(EOculusXRBone::Pinky_Tip);
-#endif
-
+	return OculusBones[static_cast<int32>(Keypoint)];
+#else
 	return 0;
+#endif
 }
 
-// Code forked from UXRVisualizationFunctionLibrary::RenderFinger
-void UFSInstancedHand::RenderFinger(const FXRMotionControllerData& InData, const EHandKeypoint FingerStart,
-                                    const EHandKeypoint FingerEnd) const
+void UFSInstancedHand::UpdateCollision(const FFSHandPoseSnapshot* Pose)
 {
-	const uint32 IndexStart = static_cast<uint32>(FingerStart);
-	const uint32 IndexStop = static_cast<uint32>(FingerEnd);
+	FS_HAND_TRACKING_SCOPE(Collision);
 
-	const bool bValid = ((IndexStart > 0) && (IndexStart < EHandKeypointCount)) &&
-		((IndexStop > 0) && (IndexStop < EHandKeypointCount)) &&
-		(EHandKeypointCount == InData.HandKeyPositions.Num()) && (EHandKeypointCount == InData.HandKeyRadii.Num());
+	auto OnContact = [this](UPrimitiveComponent* Component, const int32 Keypoint, const bool bBegin)
+	{
+		FFSHandContactDelegate& Delegate = bBegin ? OnContactBegin : OnContactEnd;
+		Delegate.Broadcast(Component, static_cast<EHandKeypoint>(Keypoint));
+	};
 
-	if (!bValid) return;
+	const UFSHandTrackingSubsystem* Subsystem = TrackingSubsystem.Get();
 
-	const UWorld* World = GetWorld();
+	if (Pose != nullptr && bEnableCollision && Subsystem != nullptr)
+		Collision.Update(Pose->Locations, Pose->Radii, Subsystem->GetInteractables(), CollisionStaticThreshold, OnContact);
+	else
+		Collision.Clear(OnContact);
+}
 
-	if (bRenderWireframePalm)
+void UFSInstancedHand::TraceHandRay()
+{
+	UWorld* World = GetWorld();
+
+	if (!bTraceHandRay || !bHandTracked || PointerContainer == nullptr || World == nullptr)
 	{
-		DrawDebugLine(World, InData.HandKeyPositions[0], InData.HandKeyPositions[1], WireframeColor, false,
-		              -1, HandPointerDepth, WireframeThickness);
-		DrawDebugLine(World, InData.HandKeyPositions[1], InData.HandKeyPositions[IndexStart], WireframeColor,
-		              false, -1, HandPointerDepth, WireframeThickness);
+		HandRayTrace = FTraceHandle();
+		bHasTracedRay = false;
+		SetHandRayHit(nullptr);
+		return;
 	}
 
-	//Iterate from FingerStart to Finger End
-	for (uint32 DigitIndex = IndexStart; DigitIndex < IndexStop; ++DigitIndex)
+	const FVector Start = PointerContainer->GetComponentLocation();
+	const FVector Direction = PointerContainer->GetForwardVector();
+
+	// The previous hit is kept while the ray barely moves.
+	if (bHasTracedRay && FVector::DistSquared(Start, TracedRayStart) <= FMath::Square(HandRayReuseDistance) &&
+		(Direction | TracedRayDirection) >= FMath::Cos(FMath::DegreesToRadians(HandRayReuseAngle)))
+		return;
+
+	// One trace in flight at most.
+	if (World->IsTraceHandleValid(HandRayTrace, false)) return;
+
+	const FCollisionQueryParams Params(SCENE_QUERY_STAT(FSHandRay), false, GetOwner());
+	HandRayTrace = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, Start + Direction * HandRayLength,
+	                                              HandRayChannel, Params, FCollisionResponseParams::DefaultResponseParam,
+	                                              &HandRayDelegate);
+	TracedRayStart = Start;
+	TracedRayDirection = Direction;
+	bHasTracedRay = true;
+
+	FS_HAND_TRACKING_COUNT(HandRayTraces, 1);
+}
+
+void UFSInstancedHand::OnHandRayTraced(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	// Results of a trace issued before the ray was reset are dropped.
+	if (!(Handle == HandRayTrace)) return;
+
+	HandRayTrace = FTraceHandle();
+	SetHandRayHit(Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit ? &Datum.OutHits[0] : nullptr);
+}
+
+void UFSInstancedHand::SetHandRayHit(const FHitResult* Hit)
+{
+	const UPrimitiveComponent* Previous = bHandRayHit ? HandRayHit.GetComponent() : nullptr;
+	const UPrimitiveComponent* Current = Hit != nullptr ? Hit->GetComponent() : nullptr;
+	const bool bChanged = Previous != Current || bHandRayHit != (Hit != nullptr);
+
+	if (bChanged && bHandRayHit)
+		OnHandRayHoverEnd.Broadcast(this, HandRayHit);
+
+	bHandRayHit = Hit != nullptr;
+
+	if (Hit != nullptr)
+		HandRayHit = *Hit;
+
+	if (bChanged && bHandRayHit)
+		OnHandRayHoverBegin.Broadcast(this, HandRayHit);
+}
+
+bool UFSInstancedHand::GetHandRayHit(FHitResult& OutHit) const
+{
+	if (bHandRayHit)
+		OutHit = HandRayHit;
+
+	return bHandRayHit;
+}
+
+void UFSInstancedHand::UpdateWireframe(const FFSHandPoseSnapshot* Pose, const bool bPoseChanged)
+{
+	FS_HAND_TRACKING_SCOPE(Wireframe);
+
+	const bool bRenderWireframe = Pose != nullptr && (!bHideHand && HandRendering == EFSOpenXRHandRendering::Both ||
+		HandRendering == EFSOpenXRHandRendering::Wireframe);
+
+	if (!bRenderWireframe)
 	{
-		DrawDebugLine(World, InData.HandKeyPositions[DigitIndex], InData.HandKeyPositions[DigitIndex + 1],
-		              WireframeColor, false, -1, HandPointerDepth, WireframeThickness);
+		if (WireframeComponent != nullptr)
+			WireframeComponent->SetVisibility(false);
 
-		if (bRenderWireframeBones)
-		{
-			DrawDebugSphere(World, InData.HandKeyPositions[DigitIndex + 1], InData.HandKeyRadii[DigitIndex + 1], 4,
-			                WireframeColor, false, -1, HandPointerDepth, WireframeThickness);
-		}
+		return;
+	}
+
+	// A hidden wireframe wasn't updated, its pose is stale.
+	const bool bWasVisible = WireframeComponent != nullptr && WireframeComponent->IsVisible();
+
+	if (WireframeComponent == nullptr)
+	{
+		UObject* Outer = GetOwner() != nullptr ? static_cast<UObject*>(GetOwner()) : this;
+		WireframeComponent = NewObject<UFSHandWireframeComponent>(Outer, NAME_None, RF_Transient);
+		WireframeComponent->SetupAttachment(this);
+		WireframeComponent->RegisterComponentWithWorld(GetWorld());
 	}
+
+	WireframeComponent->SetWireframeStyle(WireframeColor, WireframeThickness, bRenderWireframePalm,
+	                                      bRenderWireframeBones);
+	WireframeComponent->SetDepthPriorityGroup(HandPointerDepth > 0 ? SDPG_Foreground : SDPG_World);
+
+	if (bPoseChanged || !bWasVisible)
+		WireframeComponent->UpdatePose(*Pose);
+
+	WireframeComponent->SetVisibility(true);
 }
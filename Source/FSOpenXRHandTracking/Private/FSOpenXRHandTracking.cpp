@@ -1,9 +1,40 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "FSOpenXRHandTracking.h"
+#include "Engine/Engine.h"
+#include "FSHandLateLatchViewExtension.h"
+#include "FSHandTrackingStats.h"
+#include "SceneViewExtension.h"
 
 #define LOCTEXT_NAMESPACE "FFSOpenXRHandTrackingModule"
 
+DEFINE_LOG_CATEGORY(LogFSHandTracking);
+
+DEFINE_STAT(STAT_FSHandTracking_SubsystemTick);
+DEFINE_STAT(STAT_FSHandTracking_ProcessHand);
+DEFINE_STAT(STAT_FSHandTracking_ApplyHand);
+DEFINE_STAT(STAT_FSHandTracking_Filter);
+DEFINE_STAT(STAT_FSHandTracking_Pinch);
+DEFINE_STAT(STAT_FSHandTracking_RelativeRotations);
+DEFINE_STAT(STAT_FSHandTracking_Instances);
+DEFINE_STAT(STAT_FSHandTracking_Wireframe);
+DEFINE_STAT(STAT_FSHandTracking_Collision);
+DEFINE_STAT(STAT_FSHandTracking_InputInjection);
+DEFINE_STAT(STAT_FSHandTracking_HandPointer);
+DEFINE_STAT(STAT_FSHandTracking_HandRays);
+DEFINE_STAT(STAT_FSHandTracking_Gestures);
+DEFINE_STAT(STAT_FSHandTracking_AnimNodeEvaluate);
+DEFINE_STAT(STAT_FSHandTracking_GetDataFromSkeleton);
+DEFINE_STAT(STAT_FSHandTracking_InstancesTouched);
+DEFINE_STAT(STAT_FSHandTracking_InputInjections);
+DEFINE_STAT(STAT_FSHandTracking_TrackingFlips);
+DEFINE_STAT(STAT_FSHandTracking_UnchangedPoses);
+DEFINE_STAT(STAT_FSHandTracking_HandRayTraces);
+DEFINE_STAT(STAT_FSHandTracking_HandsDeferred);
+DEFINE_STAT(STAT_FSHandTracking_Dropouts);
+
+CSV_DEFINE_CATEGORY(FSHandTracking, true);
+
 void FFSOpenXRHandTrackingModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
@@ -13,6 +44,17 @@ void FFSOpenXRHandTrackingModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+	LateLatchViewExtension.Reset();
+}
+
+TSharedPtr<FFSHandLateLatchViewExtension, ESPMode::ThreadSafe> FFSOpenXRHandTrackingModule::GetLateLatchViewExtension()
+{
+	check(IsInGameThread());
+
+	if (!LateLatchViewExtension.IsValid() && GEngine != nullptr)
+		LateLatchViewExtension = FSceneViewExtensions::NewExtension<FFSHandLateLatchViewExtension>();
+
+	return LateLatchViewExtension;
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FSPinchDetector.h"
+#include "FSHandSkeleton.h"
+
+FFSPinchDetector::FFSPinchDetector()
+	: PinchMask(0), PressedMask(0), ReleasedMask(0)
+{
+	Reset();
+}
+
+void FFSPinchDetector::Reset()
+{
+	for (int32 Finger = 0; Finger < FingerCount; ++Finger)
+	{
+		DistancesSquared[Finger] = UE_BIG_NUMBER;
+		Strengths[Finger] = 0.0f;
+	}
+
+	ReleasedMask = PinchMask;
+	PressedMask = 0;
+	PinchMask = 0;
+}
+
+void FFSPinchDetector::Update(TConstArrayView<FVector> Positions, const float PressThreshold,
+                              const float ReleaseThreshold, const float StrengthDistance)
+{
+	PressedMask = 0;
+	ReleasedMask = 0;
+
+	if (Positions.Num() < FSHandSkeleton::KeypointCount) return;
+
+	const FVector& Thumb = Positions[FSHandSkeleton::ThumbTip];
+
+	// Squared distances for all fingers in one pass.
+	for (int32 Finger = 0; Finger < FingerCount; ++Finger)
+	{
+		const FVector Delta = Positions[FSHandSkeleton::GetPinchTipIndex(Finger)] - Thumb;
+		DistancesSquared[Finger] = static_cast<float>(Delta.SizeSquared());
+	}
+
+	const float PressSquared = FMath::Square(PressThreshold);
+	const float ReleaseSquared = FMath::Square(FMath::Max(PressThreshold, ReleaseThreshold));
+	const float StrengthStart = FMath::Max(PressThreshold, StrengthDistance);
+	const float StrengthRange = FMath::Max(StrengthStart - PressThreshold, UE_KINDA_SMALL_NUMBER);
+
+	uint8 NewMask = 0;
+
+	for (int32 Finger = 0; Finger < FingerCount; ++Finger)
+	{
+		const float DistanceSquared = DistancesSquared[Finger];
+		const uint8 Bit = 1 << Finger;
+
+		// Hysteresis: keep the previous state between the two thresholds.
+		if (DistanceSquared <= PressSquared || ((PinchMask & Bit) != 0 && DistanceSquared <= ReleaseSquared))
+			NewMask |= Bit;
+
+		// Only take a square root when the finger is close enough to have a strength.
+		Strengths[Finger] = DistanceSquared >= FMath::Square(StrengthStart)
+			                    ? 0.0f
+			                    : FMath::Clamp((StrengthStart - FMath::Sqrt(DistanceSquared)) / StrengthRange, 0.0f,
+			                                   1.0f);
+	}
+
+	PressedMask = NewMask & ~PinchMask;
+	ReleasedMask = PinchMask & ~NewMask;
+	PinchMask = NewMask;
+}
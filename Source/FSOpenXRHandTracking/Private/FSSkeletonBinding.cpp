@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "FSSkeletonBinding.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "Engine/SkinnedAsset.h"
+#include "UObject/ObjectKey.h"
+
+namespace
+{
+	constexpr float DefaultRadius = 0.2f;
+
+	TMap<TObjectKey<USkinnedAsset>, FFSSkeletonBinding>& GetBindings()
+	{
+		static TMap<TObjectKey<USkinnedAsset>, FFSSkeletonBinding> Bindings;
+		return Bindings;
+	}
+}
+
+const FFSSkeletonBinding* FFSSkeletonBinding::Find(const USkinnedMeshComponent* Target,
+                                                   TFunctionRef<FName(int32 Keypoint)> GetBoneName)
+{
+	check(IsInGameThread());
+
+	const USkinnedAsset* SkinnedAsset = Target != nullptr ? Target->GetSkinnedAsset() : nullptr;
+
+	if (SkinnedAsset == nullptr)
+		return nullptr;
+
+	TMap<TObjectKey<USkinnedAsset>, FFSSkeletonBinding>& Bindings = GetBindings();
+
+	if (const FFSSkeletonBinding* Binding = Bindings.Find(SkinnedAsset))
+		return Binding;
+
+	// New asset, drop the bindings of destroyed ones.
+	for (auto It = Bindings.CreateIterator(); It; ++It)
+	{
+		if (!It.Value().Asset.IsValid())
+			It.RemoveCurrent();
+	}
+
+	FFSSkeletonBinding& Binding = Bindings.Add(SkinnedAsset);
+	Binding.Asset = SkinnedAsset;
+
+	for (int32 i = 0; i < FSHandSkeleton::KeypointCount; i++)
+		Binding.BoneIndices[i] = Target->GetBoneIndex(GetBoneName(i));
+
+	return &Binding;
+}
+
+void FFSSkeletonBinding::ReadWorldSpace(const USkinnedMeshComponent* Target, FXRMotionControllerData& OutData) const
+{
+	constexpr int32 Count = FSHandSkeleton::KeypointCount;
+
+	const TArray<FTransform>& ComponentSpaceTransforms = Target->GetComponentSpaceTransforms();
+	const FTransform& ComponentToWorld = Target->GetComponentTransform();
+
+	OutData.HandKeyPositions.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutData.HandKeyRotations.SetNumUninitialized(Count, EAllowShrinking::No);
+	OutData.HandKeyRadii.SetNumUninitialized(Count, EAllowShrinking::No);
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		const int32 BoneIndex = BoneIndices[i];
+		const FTransform WorldTransform = ComponentSpaceTransforms.IsValidIndex(BoneIndex)
+			                                  ? ComponentSpaceTransforms[BoneIndex] * ComponentToWorld
+			                                  : ComponentToWorld;
+
+		OutData.HandKeyPositions[i] = WorldTransform.GetLocation();
+		OutData.HandKeyRotations[i] = WorldTransform.GetRotation();
+		OutData.HandKeyRadii[i] = DefaultRadius;
+	}
+}
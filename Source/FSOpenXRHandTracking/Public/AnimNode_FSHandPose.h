@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Animation/AnimNodeBase.h"
+#include "BoneContainer.h"
+#include "FSHandPose.h"
+#include "AnimNode_FSHandPose.generated.h"
+
+class UFSInstancedHand;
+
+// Drives the finger bones of a skinned hand with the relative rotations of a UFSInstancedHand.
+// The pose is copied once on the game thread (PreUpdate), then written during the parallel evaluation.
+// The hand needs bComputeRelativeRotations.
+USTRUCT(BlueprintInternalUseOnly)
+struct FSOPENXRHANDTRACKING_API FAnimNode_FSHandPose : public FAnimNode_Base
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category=Links)
+	FPoseLink Source;
+
+	// Hand to follow. When not set, the first hand of the owning actor with the same bLeftHand is used.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FSOpenXRHandTracking", meta=(PinShownByDefault))
+	TObjectPtr<UFSInstancedHand> Hand;
+
+	UPROPERTY(EditAnywhere, Category="FSOpenXRHandTracking")
+	bool bLeftHand = false;
+
+	// Bone of each keypoint, indexed by EHandKeypoint. Keypoints without bone are skipped.
+	UPROPERTY(EditAnywhere, Category="FSOpenXRHandTracking")
+	FBoneReference Bones[FSHandSkeleton::KeypointCount];
+
+	// Rotation from the OpenXR joint space (X forward, Z up) to the local space of the bones.
+	UPROPERTY(EditAnywhere, Category="FSOpenXRHandTracking")
+	FRotator JointToBoneRotation = FRotator::ZeroRotator;
+
+	// The root keypoint (wrist) carries the world rotation of the hand, it's only written when enabled.
+	UPROPERTY(EditAnywhere, Category="FSOpenXRHandTracking")
+	bool bDriveRoot = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="FSOpenXRHandTracking", meta=(PinShownByDefault))
+	float Alpha = 1.0f;
+
+	// FAnimNode_Base interface
+	virtual void Initialize_AnyThread(const FAnimationInitializeContext& Context) override;
+	virtual void CacheBones_AnyThread(const FAnimationCacheBonesContext& Context) override;
+	virtual void Update_AnyThread(const FAnimationUpdateContext& Context) override;
+	virtual void Evaluate_AnyThread(FPoseContext& Output) override;
+	virtual void GatherDebugData(FNodeDebugData& DebugData) override;
+	virtual bool HasPreUpdate() const override { return true; }
+	virtual void PreUpdate(const UAnimInstance* InAnimInstance) override;
+
+private:
+	// Retarget table, compact pose index of each keypoint for the current LOD.
+	int32 BoneIndices[FSHandSkeleton::KeypointCount];
+	// Copy of the hand pose made on the game thread.
+	FFSHandQuatBuffer Rotations;
+	bool bHasPose = false;
+	float ActualAlpha = 0.0f;
+};
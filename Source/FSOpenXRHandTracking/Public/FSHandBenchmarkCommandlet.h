@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "FSHandBenchmarkCommandlet.generated.h"
+
+// Headless benchmark of the hand update pipeline.
+// UnrealEditor-Cmd <Project> -run=FSHandBenchmark -nullrhi -unattended [options]
+//   -Hands=N            Number of hands updated each frame (default 64)
+//   -Frames=N           Number of measured frames (default 500)
+//   -Persistent         Use the persistent instance pool
+//   -Shared             Render every hand through the shared instanced renderer
+//   -Capture=<File>     Feed a capture recorded with UFSInstancedHand::StartRecording instead of synthetic hands
+//   -Seed=N             Seed of the synthetic hands (default 0)
+//   -DropoutRate=F      Probability per second for a synthetic hand to lose tracking (default 0)
+//   -Baseline=<File>    Json baseline, the commandlet fails when a stage is slower than the baseline
+//   -Tolerance=F        Allowed regression ratio against the baseline (default 0.2)
+//   -WriteBaseline      Write the results into the baseline file instead of comparing
+UCLASS()
+class FSOPENXRHANDTRACKING_API UFSHandBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UFSHandBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
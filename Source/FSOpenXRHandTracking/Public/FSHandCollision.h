@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FSHandSkeleton.h"
+
+class UPrimitiveComponent;
+
+// Objects hands can touch. Bounds are stored as separate min/max lanes so 4 objects are tested per iteration.
+struct FSOPENXRHANDTRACKING_API FFSInteractableSet
+{
+	FFSInteractableSet();
+
+	void Add(UPrimitiveComponent* Component);
+	void Remove(const UPrimitiveComponent* Component);
+
+	// Game thread, once per frame. Destroyed components are removed.
+	void RefreshBounds();
+
+	// Incremented when an object is added, removed or moved.
+	uint32 GetVersion() const { return Version; }
+	int32 Num() const { return Components.Num(); }
+	UPrimitiveComponent* GetComponent(const int32 Index) const { return Components[Index].Get(); }
+	// As of the last refresh.
+	FBox3f GetBounds(const int32 Index) const
+	{
+		return FBox3f(FVector3f(MinX[Index], MinY[Index], MinZ[Index]), FVector3f(MaxX[Index], MaxY[Index], MaxZ[Index]));
+	}
+
+	// Objects whose bounds overlap Box.
+	void Overlap(const FBox3f& Box, TArray<int32>& OutIndices) const;
+
+private:
+	void RemoveAt(const int32 Index);
+	void SetBounds(const int32 Index, const FBox3f& Box);
+
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> Components;
+	// Padded to a multiple of 4 with empty boxes.
+	TArray<float, TAlignedHeapAllocator<16>> MinX;
+	TArray<float, TAlignedHeapAllocator<16>> MinY;
+	TArray<float, TAlignedHeapAllocator<16>> MinZ;
+	TArray<float, TAlignedHeapAllocator<16>> MaxX;
+	TArray<float, TAlignedHeapAllocator<16>> MaxY;
+	TArray<float, TAlignedHeapAllocator<16>> MaxZ;
+	uint32 Version;
+};
+
+// Capsules around every bone of a hand (keypoint to parent, radius of the thickest end) tested against an
+// interactable set. Only the objects that pass the broadphase are queried with OverlapComponent.
+// The capsule bounds are stored as min/max lanes indexed by keypoint, so 4 capsules are tested per iteration.
+struct FSOPENXRHANDTRACKING_API FFSHandCollision
+{
+	struct FContact
+	{
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+		// One bit per keypoint, the capsule of a keypoint goes to its parent.
+		uint32 KeypointMask = 0;
+	};
+
+	using FContactCallback = TFunctionRef<void(UPrimitiveComponent* Component, int32 Keypoint, bool bBegin)>;
+
+	// Contacts are kept as is when neither the hand (StaticThreshold in cm) nor the set moved.
+	void Update(const FVector* Locations, const float* Radii, const FFSInteractableSet& Set,
+	            const float StaticThreshold, FContactCallback OnContact);
+
+	// Ends every contact.
+	void Clear(FContactCallback OnContact);
+
+	const TArray<FContact>& GetContacts() const { return Contacts; }
+
+private:
+	static constexpr int32 CapsuleLaneCount = (FSHandSkeleton::KeypointCount + 3) & ~3;
+
+	void SetContacts(FContactCallback OnContact);
+
+	// Padded with empty boxes, the root keypoint has no capsule.
+	alignas(16) float CapsuleMinX[CapsuleLaneCount];
+	alignas(16) float CapsuleMinY[CapsuleLaneCount];
+	alignas(16) float CapsuleMinZ[CapsuleLaneCount];
+	alignas(16) float CapsuleMaxX[CapsuleLaneCount];
+	alignas(16) float CapsuleMaxY[CapsuleLaneCount];
+	alignas(16) float CapsuleMaxZ[CapsuleLaneCount];
+	float CapsuleRadii[FSHandSkeleton::KeypointCount];
+
+	TArray<FContact> Contacts;
+	TArray<FContact> NewContacts;
+	TArray<int32> Candidates;
+	FVector LastLocations[FSHandSkeleton::KeypointCount];
+	uint32 LastVersion = 0;
+	bool bHasLastLocations = false;
+};
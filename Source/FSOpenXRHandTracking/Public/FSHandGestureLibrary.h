@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "FSHandPose.h"
+#include "FSHandGestureLibrary.generated.h"
+
+class UInputAction;
+
+// Compact description of a static hand pose, every value is roughly in [0, 1].
+USTRUCT(BlueprintType)
+struct FSOPENXRHANDTRACKING_API FFSHandGestureFeatures
+{
+	GENERATED_BODY()
+
+	static constexpr int32 FeatureCount = 10;
+
+	// Bend of each finger, 0 = straight.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Gestures")
+	float ThumbCurl = 0.0f;
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Gestures")
+	float IndexCurl = 0.0f;
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Gestures")
+	float MiddleCurl = 0.0f;
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Gestures")
+	float RingCurl = 0.0f;
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Gestures")
+	float LittleCurl = 0.0f;
+	// Spread between adjacent fingers, 0 = closed.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Gestures")
+	float ThumbIndexSplay = 0.0f;
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Gestures")
+	float IndexMiddleSplay = 0.0f;
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Gestures")
+	float MiddleRingSplay = 0.0f;
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Gestures")
+	float RingLittleSplay = 0.0f;
+	// How much the thumb points toward the palm.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Gestures")
+	float ThumbOpposition = 0.0f;
+
+	// Curls, splays then the thumb opposition, the order of the feature-major columns of UFSHandGestureLibrary.
+	void ToArray(float OutValues[FeatureCount]) const;
+
+	// Relative rotations as computed with bComputeRelativeRotations.
+	static FFSHandGestureFeatures FromRelativeRotations(const FFSHandQuatBuffer& RelativeRotations);
+};
+
+USTRUCT(BlueprintType)
+struct FSOPENXRHANDTRACKING_API FFSHandGestureTemplate
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Gestures")
+	FName Name;
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Gestures")
+	FFSHandGestureFeatures Features;
+	// Maximum distance in feature space to recognize the gesture.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Gestures")
+	float Tolerance = 0.25f;
+	// Injected while the gesture is held, optional.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Gestures")
+	TObjectPtr<UInputAction> InputAction;
+};
+
+// Set of gesture templates, matched with a SIMD nearest-template search over a feature-major copy of the library.
+UCLASS(BlueprintType)
+class FSOPENXRHANDTRACKING_API UFSHandGestureLibrary : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+	// Feature-major template values, padded to a multiple of 4 templates.
+	TArray<float, TAlignedHeapAllocator<16>> Columns;
+	TArray<float, TAlignedHeapAllocator<16>> InvToleranceSquared;
+	int32 PaddedCount = 0;
+	bool bCacheDirty = true;
+
+public:
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Gestures")
+	TArray<FFSHandGestureTemplate> Gestures;
+
+	// Index of the closest template and its distance relative to the template tolerance (<= 1 means recognized).
+	// Game thread only, INDEX_NONE if the library is empty.
+	int32 FindNearest(const FFSHandGestureFeatures& Features, float& OutScore);
+	// Distance to one template relative to its tolerance, MAX_flt if the index is invalid.
+	float GetScore(const int32 Gesture, const FFSHandGestureFeatures& Features) const;
+
+	// Must be called after Gestures is modified at runtime.
+	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Gestures")
+	void InvalidateCache() { bCacheDirty = true; }
+
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+private:
+	void BuildCache();
+};
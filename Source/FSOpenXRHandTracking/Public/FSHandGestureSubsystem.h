@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FSHandGestureLibrary.h"
+#include "FSHandMotionLibrary.h"
+#include "FSHandGestureSubsystem.generated.h"
+
+class UEnhancedInputLocalPlayerSubsystem;
+class UFSHandTrackingSubsystem;
+class UFSInstancedHand;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FFSHandGestureDelegate, UFSInstancedHand*, Hand, FName, Gesture);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FFSHandGestureStayDelegate, UFSInstancedHand*, Hand, FName, Gesture,
+                                               float, Duration);
+
+// Recognizes static gestures of every hand registered to UFSHandTrackingSubsystem, using the templates of Library.
+// Hands must have bComputeRelativeRotations enabled. Gestures are evaluated right after the tracking subsystem updated
+// its hands, manual hands updated later in the frame are evaluated with their previous pose.
+// Motion gestures of MotionLibrary are matched against the palm velocities of hands with bKeepPoseHistory enabled.
+UCLASS()
+class FSOPENXRHANDTRACKING_API UFSHandGestureSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	struct FHandState
+	{
+		TWeakObjectPtr<UFSInstancedHand> Hand;
+		int32 Gesture = INDEX_NONE;
+		FName GestureName;
+		float Duration = 0.0f;
+		TWeakObjectPtr<const UInputAction> InjectedAction;
+		FFSHandMotionMatcher MotionMatcher;
+		// Push count of the pose history when the matcher was last updated.
+		int64 MotionFrame = 0;
+	};
+
+	UPROPERTY()
+	TObjectPtr<UFSHandGestureLibrary> Library;
+	UPROPERTY()
+	TObjectPtr<UFSHandMotionLibrary> MotionLibrary;
+
+	TArray<FHandState> HandStates;
+	TWeakObjectPtr<UEnhancedInputLocalPlayerSubsystem> InputSubsystem;
+	TWeakObjectPtr<UFSHandTrackingSubsystem> TrackingSubsystem;
+	FDelegateHandle HandsUpdatedHandle;
+
+public:
+	// The current gesture exits when its distance goes above its tolerance scaled by this value.
+	UPROPERTY(BlueprintReadWrite, Category="FSOpenXRHandTracking|Gestures")
+	float ExitToleranceScale = 1.2f;
+
+	UPROPERTY(BlueprintAssignable, Category="FSOpenXRHandTracking|Gestures")
+	FFSHandGestureDelegate OnGestureEnter;
+	// Broadcast every frame while a gesture is held.
+	UPROPERTY(BlueprintAssignable, Category="FSOpenXRHandTracking|Gestures")
+	FFSHandGestureStayDelegate OnGestureStay;
+	UPROPERTY(BlueprintAssignable, Category="FSOpenXRHandTracking|Gestures")
+	FFSHandGestureDelegate OnGestureExit;
+	// Broadcast once when a motion gesture is over.
+	UPROPERTY(BlueprintAssignable, Category="FSOpenXRHandTracking|Gestures")
+	FFSHandGestureDelegate OnMotionGesture;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+	// Current gestures exit when the library changes.
+	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Gestures")
+	void SetLibrary(UFSHandGestureLibrary* InLibrary);
+	UFUNCTION(BlueprintPure, Category="FSOpenXRHandTracking|Gestures")
+	UFSHandGestureLibrary* GetLibrary() const { return Library; }
+
+	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Gestures")
+	void SetMotionLibrary(UFSHandMotionLibrary* InLibrary);
+	UFUNCTION(BlueprintPure, Category="FSOpenXRHandTracking|Gestures")
+	UFSHandMotionLibrary* GetMotionLibrary() const { return MotionLibrary; }
+
+	// None when the hand doesn't hold any gesture.
+	UFUNCTION(BlueprintPure, Category="FSOpenXRHandTracking|Gestures")
+	FName GetCurrentGesture(const UFSInstancedHand* Hand) const;
+
+	// Features of the current pose of a hand, to author gesture templates.
+	UFUNCTION(BlueprintPure, Category="FSOpenXRHandTracking|Gestures")
+	static FFSHandGestureFeatures GetHandFeatures(const UFSInstancedHand* Hand);
+
+	// Latest palm velocity of a hand in the space of the hand component, to author motion templates.
+	UFUNCTION(BlueprintPure, Category="FSOpenXRHandTracking|Gestures")
+	static FVector GetHandMotionFeature(const UFSInstancedHand* Hand);
+
+private:
+	// Bound to UFSHandTrackingSubsystem::OnHandsUpdated.
+	void EvaluateGestures(const float DeltaTime);
+	FHandState& FindOrAddState(UFSInstancedHand* Hand);
+	void SetGesture(FHandState& State, const int32 Gesture);
+	void UpdateMotions(UFSInstancedHand* Hand, FHandState& State);
+	void ExitAll();
+	UEnhancedInputLocalPlayerSubsystem* GetInputSubsystem();
+};
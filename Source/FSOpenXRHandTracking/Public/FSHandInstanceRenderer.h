@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "FSHandSkeleton.h"
+#include "FSHandInstanceRenderer.generated.h"
+
+// Instanced mesh shared by many hands, they all render in one draw call.
+// Each hand owns a block of KeypointCount consecutive instances. Instances are never removed: a freed block is
+// hidden with a zero scale and reused by the next hand, so instance indices never move.
+// Per-instance custom data (PerInstanceCustomData in materials): 0 hand id, 1-3 color, 4 tracking state.
+UCLASS(ClassGroup=(Custom))
+class FSOPENXRHANDTRACKING_API UFSHandInstanceRenderer : public UInstancedStaticMeshComponent
+{
+	GENERATED_BODY()
+
+	TArray<int32> FreeBlocks;
+	// Last custom data of each block, instances are only updated when it changes.
+	TArray<float> BlockCustomData;
+	TArray<FTransform> HiddenTransforms;
+
+	void SetBlockCustomData(const int32 Block, const FLinearColor& Color, const bool bTracked);
+
+public:
+	static constexpr int32 BlockSize = FSHandSkeleton::KeypointCount;
+	static constexpr int32 CustomDataCount = 5;
+
+	UFSHandInstanceRenderer();
+
+	// Reuses a free block or grows the instance buffer by one block.
+	int32 AllocateBlock();
+	void FreeBlock(const int32 Block);
+
+	// BlockSize world transforms indexed by EHandKeypoint, hidden bones have a zero scale.
+	void UpdateBlock(const int32 Block, const TArray<FTransform>& Transforms, const FLinearColor& Color);
+	// Keeps the block allocated, its tracking state is set to 0.
+	void HideBlock(const int32 Block);
+
+	int32 GetBlockCount() const { return GetInstanceCount() / BlockSize; }
+	int32 GetFreeBlockCount() const { return FreeBlocks.Num(); }
+};
@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SceneViewExtension.h"
+
+class FFSHandPosePipeline;
+
+// Latches the freshest pose of every registered pipeline on the render thread, right before the view family renders,
+// and passes it to the late latch callback of the pipeline. Owned by the module.
+class FSOPENXRHANDTRACKING_API FFSHandLateLatchViewExtension : public FSceneViewExtensionBase
+{
+public:
+	explicit FFSHandLateLatchViewExtension(const FAutoRegister& AutoRegister);
+
+	// Created on first use, requires GEngine. Invalid once the module is shut down.
+	static TSharedPtr<FFSHandLateLatchViewExtension, ESPMode::ThreadSafe> Get();
+
+	// Game thread
+	void Register(const TSharedRef<FFSHandPosePipeline, ESPMode::ThreadSafe>& Pipeline);
+	void Unregister(const TSharedRef<FFSHandPosePipeline, ESPMode::ThreadSafe>& Pipeline);
+
+	virtual void SetupViewFamily(FSceneViewFamily& InViewFamily) override
+	{
+	}
+
+	virtual void SetupView(FSceneViewFamily& InViewFamily, FSceneView& InView) override
+	{
+	}
+
+	virtual void BeginRenderViewFamily(FSceneViewFamily& InViewFamily) override
+	{
+	}
+
+	virtual void PreRenderViewFamily_RenderThread(FRDGBuilder& GraphBuilder, FSceneViewFamily& InViewFamily) override;
+
+private:
+	// Render thread only
+	TArray<TSharedRef<FFSHandPosePipeline, ESPMode::ThreadSafe>> Pipelines;
+};
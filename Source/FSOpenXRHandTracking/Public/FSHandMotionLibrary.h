@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "FSHandMotionLibrary.generated.h"
+
+// Motion gesture described by a sequence of palm velocities.
+USTRUCT(BlueprintType)
+struct FSOPENXRHANDTRACKING_API FFSHandMotionTemplate
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Gestures")
+	FName Name;
+	// Palm velocities (cm/s) in the space of the hand component, resampled to TemplateLength samples.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Gestures")
+	TArray<FVector> Samples;
+	// Maximum average distance (cm/s) between the motion and the template.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Gestures")
+	float Threshold = 50.0f;
+};
+
+// Set of motion templates, resampled to a fixed length so matching costs the same for every template.
+UCLASS(BlueprintType)
+class FSOPENXRHANDTRACKING_API UFSHandMotionLibrary : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+	// Template major, TemplateLength samples per template.
+	TArray<float, TAlignedHeapAllocator<16>> X;
+	TArray<float, TAlignedHeapAllocator<16>> Y;
+	TArray<float, TAlignedHeapAllocator<16>> Z;
+	TArray<float> MaxCosts;
+	uint32 Version = 0;
+	bool bCacheDirty = true;
+
+public:
+	static constexpr int32 TemplateLength = 16;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Gestures")
+	TArray<FFSHandMotionTemplate> Motions;
+
+	// A match is reported at most this number of samples after its end, even if a better one could follow.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Gestures")
+	int32 MaxReportDelay = 8;
+
+	// Must be called after Motions is modified at runtime.
+	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Gestures")
+	void InvalidateCache() { bCacheDirty = true; }
+
+	// Game thread only, builds the resampled templates if needed.
+	void UpdateCache();
+
+	int32 GetTemplateCount() const { return MaxCosts.Num(); }
+	uint32 GetVersion() const { return Version; }
+	const float* GetX(const int32 Template) const { return &X[Template * TemplateLength]; }
+	const float* GetY(const int32 Template) const { return &Y[Template * TemplateLength]; }
+	const float* GetZ(const int32 Template) const { return &Z[Template * TemplateLength]; }
+	// Squared distance summed over a template, Threshold converted to the accumulated cost of the matcher.
+	float GetMaxCost(const int32 Template) const { return MaxCosts[Template]; }
+
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+};
+
+// Streaming subsequence DTW (SPRING) of one hand against every template of a library.
+// Each sample updates one cost column per template, so the cost per sample is constant and no window is kept.
+struct FSOPENXRHANDTRACKING_API FFSHandMotionMatcher
+{
+	static constexpr int32 TemplateLength = UFSHandMotionLibrary::TemplateLength;
+
+	void Reset();
+
+	// Feeds the sample of index Frame, OnMatch(Template, Cost, StartFrame, EndFrame) is called for final matches.
+	void Update(UFSHandMotionLibrary& Library, const FVector3f& Feature, const int64 Frame,
+	            TFunctionRef<void(int32 Template, float Cost, int64 StartFrame, int64 EndFrame)> OnMatch);
+
+private:
+	struct FTemplateState
+	{
+		float Costs[TemplateLength];
+		int64 Starts[TemplateLength];
+		float BestCost;
+		int64 BestStart;
+		int64 BestEnd;
+	};
+
+	static void ResetState(FTemplateState& State);
+
+	TArray<FTemplateState> States;
+	TWeakObjectPtr<const UFSHandMotionLibrary> BoundLibrary;
+	uint32 BoundVersion = 0;
+};
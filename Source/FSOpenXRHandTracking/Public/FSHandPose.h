@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FSHandSkeleton.h"
+
+// Rotations of every keypoint of a hand, stored as separate x/y/z/w lanes so a whole hand
+// can be processed 4 joints at a time. Padding lanes are kept to the identity.
+struct FSOPENXRHANDTRACKING_API FFSHandQuatBuffer
+{
+	static constexpr int32 LaneCount = Align(FSHandSkeleton::KeypointCount, 4);
+
+	alignas(16) float X[LaneCount];
+	alignas(16) float Y[LaneCount];
+	alignas(16) float Z[LaneCount];
+	alignas(16) float W[LaneCount];
+
+	FFSHandQuatBuffer();
+
+	void Reset();
+	void Load(TConstArrayView<FQuat> Rotations);
+
+	FORCEINLINE void SetQuat(const int32 Index, const FQuat& Quat)
+	{
+		X[Index] = static_cast<float>(Quat.X);
+		Y[Index] = static_cast<float>(Quat.Y);
+		Z[Index] = static_cast<float>(Quat.Z);
+		W[Index] = static_cast<float>(Quat.W);
+	}
+
+	FORCEINLINE FQuat GetQuat(const int32 Index) const
+	{
+		return FQuat(X[Index], Y[Index], Z[Index], W[Index]);
+	}
+};
+
+// Joint state of one hand. The joint count is known at compile time, so the pose is stored inline
+// and aligned on a cache line, and whole hands are read through views without any allocation.
+struct alignas(PLATFORM_CACHE_LINE_SIZE) FFSHandJointPose
+{
+	static constexpr int32 JointCount = FSHandSkeleton::KeypointCount;
+
+	FVector Locations[JointCount];
+	FQuat Rotations[JointCount];
+	FFSHandQuatBuffer RelativeRotations;
+
+	FFSHandJointPose()
+	{
+		for (int32 i = 0; i < JointCount; i++)
+		{
+			Locations[i] = FVector::ZeroVector;
+			Rotations[i] = FQuat::Identity;
+		}
+	}
+
+	TConstArrayView<FVector> GetLocations() const { return MakeArrayView(Locations); }
+	TConstArrayView<FQuat> GetRotations() const { return MakeArrayView(Rotations); }
+	FORCEINLINE FTransform GetTransform(const int32 Index) const { return FTransform(Rotations[Index], Locations[Index]); }
+
+	void GetTransforms(TArrayView<FTransform> OutTransforms) const
+	{
+		check(OutTransforms.Num() == JointCount);
+
+		for (int32 i = 0; i < JointCount; i++)
+			OutTransforms[i] = GetTransform(i);
+	}
+};
+
+namespace FSHandPose
+{
+	// Computes the rotation of every bone relative to its parent (Inverse(Parent) * Bone).
+	// The root keeps its world rotation. World rotations are expected to be normalized.
+	FSOPENXRHANDTRACKING_API void ComputeRelativeRotations(const FFSHandQuatBuffer& WorldRotations,
+	                                                       FFSHandQuatBuffer& OutRelativeRotations);
+
+	// Same as above for a batch of hands.
+	FSOPENXRHANDTRACKING_API void ComputeRelativeRotations(TConstArrayView<FFSHandQuatBuffer> WorldRotations,
+	                                                       TArrayView<FFSHandQuatBuffer> OutRelativeRotations);
+}
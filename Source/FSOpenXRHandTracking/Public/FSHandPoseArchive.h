@@ -0,0 +1,147 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HeadMountedDisplayTypes.h"
+#include "FSHandPoseRecording.h"
+#include "FSPinchDetector.h"
+
+// Compressed archive of long sessions, for offline analytics (little endian):
+// [FFSHandPoseArchiveHeader][Chunk 0][Chunk 1]...[FFSHandArchiveChunk index]
+// A chunk holds up to ChunkFrameCount frames stored column by column: each column (timestamp, state, and the
+// components of every joint position, rotation and radius) starts with a keyframe followed by the quantized deltas
+// of the next frames, as zigzag varints. The index at the end of the file has the byte range and the feature
+// ranges of every chunk, so queries only read and decode the chunks that can match.
+
+struct FFSHandPoseArchiveHeader
+{
+	static constexpr uint32 ExpectedMagic = 0x41485346; // "FSHA"
+	static constexpr uint32 CurrentVersion = 1;
+
+	uint32 Magic;
+	uint32 Version;
+	uint32 ChunkFrameCount;
+	uint32 KeypointCount;
+	int64 IndexOffset;
+	uint32 ChunkCount;
+	uint32 Reserved;
+};
+
+static_assert(sizeof(FFSHandPoseArchiveHeader) == 32, "The archive header layout must not change");
+
+// Features derived from a frame, indexed per chunk.
+struct FSOPENXRHANDTRACKING_API FFSHandArchiveFeatures
+{
+	// Thumb tip to finger tip, indexed by EFSOpenXRPinchFingers.
+	float PinchDistances[FFSPinchDetector::FingerCount] = {};
+	// Palm speed since the previous frame of the chunk (cm/s), 0 for the first frame.
+	float PalmSpeed = 0.0f;
+	bool bTracked = false;
+
+	static FFSHandArchiveFeatures Compute(const FFSHandPoseFrame& Frame, const FFSHandPoseFrame* Previous);
+};
+
+struct FFSHandArchiveChunk
+{
+	int64 Offset;
+	uint32 Size;
+	uint32 FrameCount;
+	double StartTime;
+	double EndTime;
+	// Ranges over the tracked frames, Min > Max when the chunk has none.
+	float MinPinchDistances[FFSPinchDetector::FingerCount];
+	float MaxPinchDistances[FFSPinchDetector::FingerCount];
+	float MinPalmSpeed;
+	float MaxPalmSpeed;
+	uint32 TrackedFrameCount;
+	uint32 Reserved;
+};
+
+static_assert(sizeof(FFSHandArchiveChunk) == 80, "The archive chunk layout must not change");
+
+// Frames to look for, every set condition must be true.
+struct FSOPENXRHANDTRACKING_API FFSHandArchiveQuery
+{
+	double StartTime = 0.0;
+	double EndTime = MAX_dbl;
+	bool bTrackingLost = false;
+	bool bTracked = false;
+	// Index of EFSOpenXRPinchFingers, pinching while its distance is at most PinchDistance (cm).
+	int32 PinchFinger = INDEX_NONE;
+	float PinchDistance = 1.5f;
+	// Palm speed (cm/s), 0 to ignore.
+	float MinPalmSpeed = 0.0f;
+
+	// False when no frame of the chunk can match.
+	bool MatchesChunk(const FFSHandArchiveChunk& Chunk) const;
+	bool MatchesFrame(const FFSHandPoseFrame& Frame, const FFSHandArchiveFeatures& Features) const;
+};
+
+// Streams FXRMotionControllerData into an archive, a chunk is encoded each time it's full.
+class FSOPENXRHANDTRACKING_API FFSHandPoseArchiveWriter
+{
+public:
+	static constexpr int32 DefaultChunkFrameCount = 256;
+
+	~FFSHandPoseArchiveWriter();
+
+	bool Open(const FString& Filename, const int32 InChunkFrameCount = DefaultChunkFrameCount);
+	// Writes the pending frames and the index.
+	void Close();
+	bool IsOpen() const { return Writer.IsValid(); }
+
+	void Record(const FXRMotionControllerData& InData);
+	void RecordFrame(const FFSHandPoseFrame& Frame);
+	int32 GetFrameCount() const { return FrameCount; }
+
+	// Archives a capture recorded with FFSHandPoseRecorder.
+	static bool ConvertCapture(const FString& CaptureFilename, const FString& ArchiveFilename,
+	                           const int32 InChunkFrameCount = DefaultChunkFrameCount);
+
+private:
+	void FlushChunk();
+
+	TUniquePtr<FArchive> Writer;
+	TArray<FFSHandPoseFrame> PendingFrames;
+	TArray<FFSHandArchiveChunk> Chunks;
+	// Quantized frames of a chunk, row major.
+	TArray<int32> Values;
+	TArray<uint8> ChunkData;
+	int32 ChunkFrameCount = DefaultChunkFrameCount;
+	double StartTime = 0.0;
+	int32 FrameCount = 0;
+};
+
+// Reads the index of an archive when opened, chunks are read and decoded on demand.
+class FSOPENXRHANDTRACKING_API FFSHandPoseArchiveReader
+{
+public:
+	bool Open(const FString& Filename);
+	void Close();
+	bool IsOpen() const { return Reader.IsValid(); }
+
+	int32 GetFrameCount() const { return FrameCount; }
+	const TArray<FFSHandArchiveChunk>& GetChunks() const { return Chunks; }
+
+	// Chunks that can contain frames matching Query, only the index is read.
+	void FindChunks(const FFSHandArchiveQuery& Query, TArray<int32>& OutChunks) const;
+
+	// OutFrames keeps its allocation.
+	bool ReadChunk(const int32 Chunk, TArray<FFSHandPoseFrame>& OutFrames);
+
+	// Decodes the candidate chunks only and calls OnFrame for each matching frame, in order.
+	// Returns the number of matching frames.
+	int32 Query(const FFSHandArchiveQuery& Query,
+	            TFunctionRef<void(const FFSHandPoseFrame& Frame, const FFSHandArchiveFeatures& Features)> OnFrame);
+
+private:
+	TUniquePtr<FArchive> Reader;
+	TArray<FFSHandArchiveChunk> Chunks;
+	// Quantized frames of a chunk, row major.
+	TArray<int32> Values;
+	TArray<uint8> ChunkData;
+	TArray<FFSHandPoseFrame> Frames;
+	TArray<int32> Candidates;
+	int32 FrameCount = 0;
+};
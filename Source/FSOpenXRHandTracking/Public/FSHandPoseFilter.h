@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FSHandPose.h"
+#include "FSHandPoseFilter.generated.h"
+
+USTRUCT(BlueprintType)
+struct FSOPENXRHANDTRACKING_API FFSHandFilterSettings
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Filtering")
+	bool bEnabled = false;
+	// Cutoff frequency (Hz) when the joint doesn't move, lower values remove more jitter.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Filtering")
+	float MinCutoff = 1.5f;
+	// Cutoff increase per cm/s of joint speed, higher values reduce the lag of fast motions.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Filtering")
+	float Beta = 0.02f;
+	// Cutoff frequency (Hz) of the velocity estimation.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Filtering")
+	float DerivativeCutoff = 1.0f;
+	// Look-ahead (seconds) applied to positions to hide the pipeline latency, 0 to disable the prediction.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Filtering")
+	float PredictionTime = 0.0f;
+	// Use a constant acceleration model instead of a constant velocity one.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Filtering")
+	bool bPredictAcceleration = false;
+};
+
+// One-Euro filter for every joint of a hand, processed 4 joints at a time.
+// Positions are filtered and optionally predicted, rotations are filtered with the cutoff of their joint.
+struct FSOPENXRHANDTRACKING_API FFSHandPoseFilter
+{
+	static constexpr int32 LaneCount = FFSHandQuatBuffer::LaneCount;
+
+	FFSHandPoseFilter();
+
+	void Reset();
+
+	// Time is in seconds, the first call (or a call after Reset) initializes the filter with the raw pose.
+	void Update(const FVector* RawLocations, const FQuat* RawRotations, const double Time,
+	            const FFSHandFilterSettings& Settings, FVector* OutLocations, FVector* OutPredictedLocations,
+	            FQuat* OutRotations);
+
+private:
+	alignas(16) float X[LaneCount];
+	alignas(16) float Y[LaneCount];
+	alignas(16) float Z[LaneCount];
+	alignas(16) float VelocityX[LaneCount];
+	alignas(16) float VelocityY[LaneCount];
+	alignas(16) float VelocityZ[LaneCount];
+	alignas(16) float AccelerationX[LaneCount];
+	alignas(16) float AccelerationY[LaneCount];
+	alignas(16) float AccelerationZ[LaneCount];
+	FFSHandQuatBuffer Rotations;
+	FVector Origin;
+	double LastTime;
+	bool bInitialized;
+};
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HeadMountedDisplayTypes.h"
+#include "FSHandSkeleton.h"
+
+struct FFSHandGeneratorSettings
+{
+	// Distance between two pairs of hands (cm).
+	float Spacing = 60.0f;
+	// Amplitude of the wrist motion (cm) and of its rotation (degrees).
+	float WristAmplitude = 8.0f;
+	float WristAngle = 20.0f;
+	// Probability for a hand to lose tracking during a second, and duration of the loss (s).
+	float DropoutRate = 0.02f;
+	float DropoutDuration = 0.3f;
+	// Uniform scale range of the hands, proportions are kept.
+	float MinHandScale = 0.9f;
+	float MaxHandScale = 1.1f;
+};
+
+// Deterministic animated hands for load tests: finger curls, pinches, wrist motion and tracking losses.
+// The same seed and time always give the same poses, every motion loops over LoopPeriod.
+// Hands are generated 4 at a time, joints are stored in joint major SoA lanes.
+class FSOPENXRHANDTRACKING_API FFSHandPoseGenerator
+{
+public:
+	static constexpr float LoopPeriod = 64.0f;
+
+	FFSHandPoseGenerator(const int32 InHandCount, const int32 Seed,
+	                     const FFSHandGeneratorSettings& InSettings = FFSHandGeneratorSettings());
+
+	int32 Num() const { return HandCount; }
+
+	// Poses every hand at Time (s).
+	void Generate(const double Time);
+
+	// Hand of the last Generate call, ready for UpdateHand. The arrays of OutData keep their allocation.
+	// Even hands are left hands.
+	void GetHandData(const int32 Hand, FXRMotionControllerData& OutData) const;
+
+private:
+	using FLanes = TArray<float, TAlignedHeapAllocator<16>>;
+
+	FORCEINLINE int32 GetLane(const int32 Joint, const int32 Hand) const { return Joint * PaddedCount + Hand; }
+
+	FFSHandGeneratorSettings Settings;
+	int32 HandCount;
+	int32 PaddedCount;
+	uint32 DropoutSeed;
+
+	// Per hand parameters
+	FLanes OriginX;
+	FLanes OriginY;
+	FLanes OriginZ;
+	FLanes Sides;
+	FLanes Scales;
+	FLanes CurlFrequencies;
+	FLanes CurlPhases[FSHandSkeleton::FingerCount];
+	FLanes PinchFrequencies;
+	FLanes PinchPhases;
+	FLanes WristFrequencies;
+	FLanes WristPhases;
+
+	// Generated joints
+	FLanes PositionX;
+	FLanes PositionY;
+	FLanes PositionZ;
+	FLanes RotationX;
+	FLanes RotationY;
+	FLanes RotationZ;
+	FLanes RotationW;
+	TBitArray<> Tracked;
+};
@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FSHandSkeleton.h"
+
+// Recent poses of a hand and their finite-difference velocities, stored in a fixed ring buffer.
+struct FSOPENXRHANDTRACKING_API FFSHandPoseHistory
+{
+	static constexpr int32 Capacity = 64;
+
+	struct FSample
+	{
+		double Time = 0.0;
+		FQuat PalmRotation = FQuat::Identity;
+		FVector Locations[FSHandSkeleton::KeypointCount];
+		// cm/s, zero for the first sample after a reset.
+		FVector3f Velocities[FSHandSkeleton::KeypointCount];
+	};
+
+	FFSHandPoseHistory();
+
+	void Reset();
+
+	// Samples older than the latest one are ignored (async pipelines can publish the same pose twice).
+	bool Push(const double Time, const FVector* Locations, const FQuat& PalmRotation);
+
+	int32 Num() const { return Count; }
+
+	// Number of samples pushed since the last reset, can be used as a frame index.
+	int64 GetPushCount() const { return PushCount; }
+
+	// Age 0 is the latest sample.
+	const FSample& GetSample(const int32 Age) const
+	{
+		check(Age >= 0 && Age < Count);
+		return Samples[(Head - Age + Capacity) % Capacity];
+	}
+
+private:
+	FSample Samples[Capacity];
+	int32 Head;
+	int32 Count;
+	int64 PushCount;
+};
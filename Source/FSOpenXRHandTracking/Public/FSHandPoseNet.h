@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HeadMountedDisplayTypes.h"
+#include "FSHandSkeleton.h"
+#include "FSHandPoseNet.generated.h"
+
+// Hand pose quantized for the network.
+// Positions are palm relative in fixed point, rotations are palm relative and packed with the
+// smallest-three method. Radii are not sent, a constant table is used on the receiving side.
+struct FSOPENXRHANDTRACKING_API FFSQuantizedHandPose
+{
+	// 1/100 cm
+	static constexpr float PositionScale = 100.0f;
+
+	bool bValid = false;
+	int32 PalmPosition[3] = {};
+	uint32 PalmRotation = 0;
+	int16 Positions[FSHandSkeleton::KeypointCount][3] = {};
+	uint32 Rotations[FSHandSkeleton::KeypointCount] = {};
+
+	void Quantize(const FXRMotionControllerData& InData);
+	void Dequantize(FVector* OutPositions, FQuat* OutRotations) const;
+
+	static uint32 PackRotation(const FQuat& Rotation);
+	static FQuat UnpackRotation(const uint32 Packed);
+};
+
+// Replicated hand pose, the payload is delta encoded against BaselineSequence (0 for a keyframe).
+USTRUCT(BlueprintType)
+struct FSOPENXRHANDTRACKING_API FFSNetHandPose
+{
+	GENERATED_BODY()
+
+	static constexpr uint32 MaxPayloadBits = 8192;
+
+	uint16 Sequence = 0;
+	uint16 BaselineSequence = 0;
+	// Sender clock, in milliseconds.
+	uint32 Timestamp = 0;
+	uint32 PayloadBits = 0;
+	TArray<uint8> Payload;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template <>
+struct TStructOpsTypeTraits<FFSNetHandPose> : TStructOpsTypeTraitsBase2<FFSNetHandPose>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+namespace FSHandPoseNet
+{
+	// Constant radius of each keypoint, in cm.
+	FSOPENXRHANDTRACKING_API float GetDefaultRadius(const int32 Keypoint);
+
+	FSOPENXRHANDTRACKING_API void Encode(const FFSQuantizedHandPose& Pose, const FFSQuantizedHandPose* Baseline,
+	                                     FFSNetHandPose& OutNetPose);
+	FSOPENXRHANDTRACKING_API bool Decode(const FFSNetHandPose& NetPose, const FFSQuantizedHandPose* Baseline,
+	                                     FFSQuantizedHandPose& OutPose);
+}
+
+// Sending side: delta encodes against the last pose acknowledged by the receiver.
+class FSOPENXRHANDTRACKING_API FFSHandPoseNetSender
+{
+public:
+	static constexpr int32 HistorySize = 32;
+
+	void Encode(const FXRMotionControllerData& InData, FFSNetHandPose& OutNetPose);
+	// Call it when the receiver reports its last received sequence.
+	void Acknowledge(const uint16 Sequence);
+
+private:
+	FFSQuantizedHandPose History[HistorySize];
+	uint16 HistorySequences[HistorySize] = {};
+	uint16 NextSequence = 1;
+	uint16 AckedSequence = 0;
+};
+
+// Receiving side: resolves deltas and buffers poses to interpolate them with a fixed delay.
+class FSOPENXRHANDTRACKING_API FFSHandPoseNetReceiver
+{
+public:
+	static constexpr int32 HistorySize = 32;
+	// About 350 ms of poses at 90 Hz.
+	static constexpr int32 BufferSize = 32;
+
+	// Seconds behind the most recent pose used for interpolation, clamped to the buffered span.
+	float InterpolationDelay = 0.1f;
+
+	// Returns false when the baseline is unknown, the pose is then dropped.
+	bool Receive(const FFSNetHandPose& NetPose, const double LocalTime);
+	// Sequence to acknowledge to the sender, 0 if nothing was received.
+	uint16 GetLastReceivedSequence() const { return LastSequence; }
+
+	// Fills OutData for LocalTime, its arrays are only allocated the first time.
+	bool Sample(const double LocalTime, const bool bLeft, FXRMotionControllerData& OutData) const;
+
+private:
+	struct FBufferedPose
+	{
+		double Time = 0.0;
+		bool bValid = false;
+		FVector Positions[FSHandSkeleton::KeypointCount];
+		FQuat Rotations[FSHandSkeleton::KeypointCount];
+	};
+
+	FFSQuantizedHandPose History[HistorySize];
+	uint16 HistorySequences[HistorySize] = {};
+	uint16 LastSequence = 0;
+
+	FBufferedPose Buffer[BufferSize];
+	int32 BufferCount = 0;
+	int32 BufferHead = 0;
+	double ClockOffset = 0.0;
+	bool bHasClockOffset = false;
+};
@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HeadMountedDisplayTypes.h"
+#include "Containers/TripleBuffer.h"
+#include "FSHandGestureLibrary.h"
+#include "FSHandPose.h"
+#include "FSHandPoseFilter.h"
+#include "FSPinchDetector.h"
+#include <atomic>
+
+// Settings copied from the hand when data is submitted, so the processing never reads the component.
+struct FFSHandProcessSettings
+{
+	float PinchThreshold = 1.5f;
+	float PinchReleaseThreshold = 2.0f;
+	float PinchStrengthDistance = 6.0f;
+	bool bComputeRelativeRotations = false;
+	FFSHandFilterSettings Filter;
+};
+
+// State carried between two processed poses of the same hand.
+struct FFSHandProcessState
+{
+	FFSPinchDetector PinchDetector;
+	FFSHandPoseFilter Filter;
+
+	void Reset()
+	{
+		PinchDetector.Reset();
+		Filter.Reset();
+	}
+};
+
+// Result of the pose processing for one hand.
+struct FSOPENXRHANDTRACKING_API FFSHandPoseSnapshot
+{
+	bool bValid = false;
+	uint8 PinchMask = 0;
+	// FPlatformTime::Seconds() when the raw data was submitted.
+	double SampleTime = 0.0;
+	// Predicted locations when filtering is enabled.
+	FVector Locations[FSHandSkeleton::KeypointCount];
+	FQuat Rotations[FSHandSkeleton::KeypointCount];
+	float Radii[FSHandSkeleton::KeypointCount];
+	float PinchStrengths[FFSPinchDetector::FingerCount] = {};
+	FFSHandQuatBuffer RelativeRotations;
+	// Computed with the relative rotations.
+	FFSHandGestureFeatures GestureFeatures;
+};
+
+// Processes hand data on a worker task and publishes the results through wait-free triple buffers.
+// Submit and ReadLatest are called from the game thread, LatchRenderThread from the render thread.
+// The instances of UFSInstancedHand use the game thread pose, the late latch is meant for custom render code.
+class FSOPENXRHANDTRACKING_API FFSHandPosePipeline : public TSharedFromThis<FFSHandPosePipeline, ESPMode::ThreadSafe>
+{
+public:
+	// Shared by the synchronous path of UFSInstancedHand and the worker task.
+	static void ProcessPose(const FXRMotionControllerData& InData, const FFSHandProcessSettings& Settings,
+	                        const double SampleTime, FFSHandProcessState& State, FFSHandPoseSnapshot& OutPose);
+
+	// Copies the raw data and wakes the worker up if it's idle.
+	void Submit(const FXRMotionControllerData& InData, const FFSHandProcessSettings& Settings);
+
+	// Latest complete pose, never blocks.
+	const FFSHandPoseSnapshot& ReadLatest();
+
+	// Freshest complete pose for the render thread, passed to the late latch callback.
+	const FFSHandPoseSnapshot& LatchRenderThread();
+
+	// Game thread. Callback invoked on the render thread with the latched pose before the view family renders,
+	// see FFSHandLateLatchViewExtension.
+	void SetOnLateLatch_RenderThread(TFunction<void(const FFSHandPoseSnapshot&)>&& Callback);
+
+private:
+	struct FRawInput
+	{
+		FXRMotionControllerData Data;
+		FFSHandProcessSettings Settings;
+		double SampleTime = 0.0;
+	};
+
+	void RunWorker();
+
+	TTripleBuffer<FRawInput> Input;
+	TTripleBuffer<FFSHandPoseSnapshot> GameOutput;
+	TTripleBuffer<FFSHandPoseSnapshot> RenderOutput;
+	FFSHandProcessState State;
+	std::atomic<bool> bWorkerRunning{false};
+	// Render thread only
+	TFunction<void(const FFSHandPoseSnapshot&)> OnLateLatch_RenderThread;
+};
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HeadMountedDisplayTypes.h"
+#include "FSHandSkeleton.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+// Capture file layout (little endian):
+// [FFSHandPoseFileHeader][FFSHandPoseFrame 0][FFSHandPoseFrame 1]...
+// Frames have a fixed size so any frame can be reached in O(1).
+
+struct FFSHandPoseFileHeader
+{
+	static constexpr uint32 ExpectedMagic = 0x50485346; // "FSHP"
+	static constexpr uint32 CurrentVersion = 1;
+
+	uint32 Magic;
+	uint32 Version;
+	uint32 HeaderSize;
+	uint32 FrameSize;
+	uint32 KeypointCount;
+	uint32 Reserved;
+};
+
+struct FFSHandPoseFrame
+{
+	// Seconds since the start of the recording.
+	double Timestamp;
+	uint8 HandIndex;
+	uint8 bValid;
+	uint8 TrackingStatus;
+	uint8 Padding[5];
+	float Positions[FSHandSkeleton::KeypointCount][3];
+	float Rotations[FSHandSkeleton::KeypointCount][4];
+	float Radii[FSHandSkeleton::KeypointCount];
+
+	void Store(const FXRMotionControllerData& InData, const double InTimestamp);
+	void Load(FXRMotionControllerData& OutData) const;
+};
+
+static_assert(sizeof(FFSHandPoseFileHeader) == 24, "The capture header layout must not change");
+static_assert(sizeof(FFSHandPoseFrame) == 16 + FSHandSkeleton::KeypointCount * 8 * sizeof(float),
+              "The capture frame layout must not change");
+
+// Streams FXRMotionControllerData into a capture file.
+class FSOPENXRHANDTRACKING_API FFSHandPoseRecorder
+{
+public:
+	~FFSHandPoseRecorder();
+
+	bool Open(const FString& Filename);
+	void Close();
+	bool IsOpen() const { return Writer.IsValid(); }
+
+	void Record(const FXRMotionControllerData& InData);
+	int32 GetFrameCount() const { return FrameCount; }
+
+private:
+	TUniquePtr<FArchive> Writer;
+	double StartTime = 0.0;
+	int32 FrameCount = 0;
+};
+
+// Memory maps a capture file and reads frames back without copying the file.
+class FSOPENXRHANDTRACKING_API FFSHandPosePlayer
+{
+public:
+	~FFSHandPosePlayer();
+
+	bool Open(const FString& Filename);
+	void Close();
+	bool IsOpen() const { return Frames != nullptr; }
+
+	int32 GetFrameCount() const { return FrameCount; }
+	double GetDuration() const;
+
+	const FFSHandPoseFrame& GetFrame(const int32 Index) const
+	{
+		check(Frames != nullptr && Index >= 0 && Index < FrameCount);
+		return Frames[Index];
+	}
+
+	// Index of the last frame recorded at or before Time, INDEX_NONE if the file is empty.
+	int32 FindFrame(const double Time) const;
+
+	// OutData arrays are only allocated the first time, reuse the same struct for every frame.
+	bool ReadFrame(const int32 Index, FXRMotionControllerData& OutData) const;
+
+private:
+	TUniquePtr<IMappedFileHandle> MappedHandle;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	const FFSHandPoseFrame* Frames = nullptr;
+	int32 FrameCount = 0;
+};
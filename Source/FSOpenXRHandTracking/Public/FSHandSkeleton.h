@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HeadMountedDisplayTypes.h"
+
+// Compile-time topology of the OpenXR hand skeleton (XR_EXT_hand_tracking joint layout).
+// All tables are indexed by EHandKeypoint.
+namespace FSHandSkeleton
+{
+	constexpr int32 KeypointCount = 26;
+	constexpr int32 FingerCount = 5;
+
+	static_assert(EHandKeypointCount == KeypointCount, "Unexpected EHandKeypoint layout");
+
+	constexpr int32 Palm = static_cast<int32>(EHandKeypoint::Palm);
+	constexpr int32 Wrist = static_cast<int32>(EHandKeypoint::Wrist);
+	constexpr int32 ThumbTip = static_cast<int32>(EHandKeypoint::ThumbTip);
+
+	// Parent of each keypoint, INDEX_NONE for the root (Wrist).
+	constexpr int32 ParentIndices[KeypointCount] =
+	{
+		1, // Palm -> Wrist
+		INDEX_NONE, // Wrist
+		0, 2, 3, 4, // Thumb
+		0, 6, 7, 8, 9, // Index
+		0, 11, 12, 13, 14, // Middle
+		0, 16, 17, 18, 19, // Ring
+		0, 21, 22, 23, 24 // Little
+	};
+
+	// Main child of each keypoint, INDEX_NONE for tips. The palm points to the middle finger.
+	constexpr int32 ChildIndices[KeypointCount] =
+	{
+		11, // Palm -> MiddleMetacarpal
+		0, // Wrist -> Palm
+		3, 4, 5, INDEX_NONE,
+		7, 8, 9, 10, INDEX_NONE,
+		12, 13, 14, 15, INDEX_NONE,
+		17, 18, 19, 20, INDEX_NONE,
+		22, 23, 24, 25, INDEX_NONE
+	};
+
+	// Finger of each keypoint (0 = Thumb ... 4 = Little), INDEX_NONE for Palm and Wrist.
+	constexpr int32 FingerIndices[KeypointCount] =
+	{
+		INDEX_NONE, INDEX_NONE,
+		0, 0, 0, 0,
+		1, 1, 1, 1, 1,
+		2, 2, 2, 2, 2,
+		3, 3, 3, 3, 3,
+		4, 4, 4, 4, 4
+	};
+
+	// First (metacarpal) and last (tip) keypoint of each finger.
+	constexpr int32 FingerStartIndices[FingerCount] = {2, 6, 11, 16, 21};
+	constexpr int32 FingerTipIndices[FingerCount] = {5, 10, 15, 20, 25};
+
+	// Parents always come before their children.
+	constexpr int32 TopologicalOrder[KeypointCount] =
+	{
+		1, 0,
+		2, 3, 4, 5,
+		6, 7, 8, 9, 10,
+		11, 12, 13, 14, 15,
+		16, 17, 18, 19, 20,
+		21, 22, 23, 24, 25
+	};
+
+	constexpr bool IsTip(const int32 Keypoint)
+	{
+		return ChildIndices[Keypoint] == INDEX_NONE;
+	}
+
+	// Tip of the finger used by EFSOpenXRPinchFingers (Index = 0 ... Little = 3).
+	constexpr int32 GetPinchTipIndex(const int32 PinchFinger)
+	{
+		return FingerTipIndices[PinchFinger + 1];
+	}
+}
@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FSHandSkeleton.h"
+#include <atomic>
+#include "FSHandTrackingQuality.generated.h"
+
+UENUM(BlueprintType)
+enum class EFSHandQualityMetric : uint8
+{
+	// Mean second difference of the joint locations between consecutive poses (cm).
+	Jitter UMETA(DisplayName="Jitter"),
+	// Time between the sample of the pose (or its submission for remote hands) and its use (ms).
+	PoseAge UMETA(DisplayName="Pose Age"),
+	// Duration of each tracking loss (ms).
+	DropoutDuration UMETA(DisplayName="Dropout Duration"),
+	// Time from the end of a tracking loss until the jitter settles (ms).
+	RecoveryTime UMETA(DisplayName="Recovery Time")
+};
+
+USTRUCT(BlueprintType)
+struct FFSHandQualityStats
+{
+	GENERATED_BODY()
+
+	// Samples in the rolling window.
+	UPROPERTY(BlueprintReadOnly, Category="FSOpenXRHandTracking|Quality")
+	int32 Count = 0;
+	// Percentiles are the upper bounds of their histogram bucket.
+	UPROPERTY(BlueprintReadOnly, Category="FSOpenXRHandTracking|Quality")
+	float Median = 0.0f;
+	UPROPERTY(BlueprintReadOnly, Category="FSOpenXRHandTracking|Quality")
+	float P95 = 0.0f;
+	UPROPERTY(BlueprintReadOnly, Category="FSOpenXRHandTracking|Quality")
+	float Max = 0.0f;
+};
+
+// Log2 histogram over a rolling window made of SliceCount slices.
+// A single thread writes, any thread can read without locks while it does.
+class FSOPENXRHANDTRACKING_API FFSRollingHistogram
+{
+public:
+	static constexpr int32 BucketCount = 24;
+	static constexpr int32 SliceCount = 5;
+
+	// Values up to Resolution go in the first bucket, each next bucket is twice as wide.
+	explicit FFSRollingHistogram(const float InResolution = 0.01f);
+
+	// Writer
+	void Add(const float Value);
+	// Drops the oldest slice and starts a new one.
+	void Rotate();
+	void Reset();
+
+	// Readers, over the whole window.
+	uint32 GetCount() const;
+	float GetPercentile(const float Percentile) const;
+	float GetMax() const;
+	FFSHandQualityStats GetStats() const;
+
+private:
+	struct FSlice
+	{
+		std::atomic<uint32> Buckets[BucketCount];
+		// Bits of a positive float, their order is the float order.
+		std::atomic<uint32> MaxBits;
+	};
+
+	float GetBucketBound(const int32 Bucket) const { return Resolution * static_cast<float>(1 << Bucket); }
+
+	FSlice Slices[SliceCount];
+	std::atomic<int32> CurrentSlice;
+	float Resolution;
+};
+
+// Tracking health of one hand: jitter, pose age, dropout durations and recovery times over a rolling window.
+// Updated by UFSInstancedHand for every applied pose when bMonitorTrackingQuality is enabled.
+class FSOPENXRHANDTRACKING_API FFSHandTrackingQuality
+{
+public:
+	static constexpr int32 MetricCount = 4;
+
+	// Length of the rolling window (s).
+	float WindowDuration = 10.0f;
+	// A recovering hand is settled once its jitter goes under this value (cm).
+	float RecoveryJitterThreshold = 0.05f;
+
+	FFSHandTrackingQuality();
+
+	// Game thread. Locations are ignored when the hand isn't tracked, SampleTime is in FPlatformTime::Seconds().
+	void Update(const double Now, const bool bTracked, const FVector* Locations, const double SampleTime);
+	void Reset();
+
+	// Any thread.
+	const FFSRollingHistogram& GetHistogram(const EFSHandQualityMetric Metric) const
+	{
+		return Histograms[static_cast<int32>(Metric)];
+	}
+
+	uint32 GetDropoutCount() const { return DropoutCount.load(std::memory_order_relaxed); }
+
+private:
+	void AddSample(const EFSHandQualityMetric Metric, const float Value);
+
+	FFSRollingHistogram Histograms[MetricCount];
+	std::atomic<uint32> DropoutCount;
+
+	// Two previous poses for the second difference.
+	FVector PreviousLocations[2][FSHandSkeleton::KeypointCount];
+	int32 PreviousCount;
+	double LastSampleTime;
+	double LostTime;
+	double RegainedTime;
+	double NextRotationTime;
+	bool bWasTracked;
+	bool bHasBeenTracked;
+	bool bRecovering;
+};
@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HeadMountedDisplayTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "FSHandCollision.h"
+#include "FSHandTrackingSubsystem.generated.h"
+
+class UFSInstancedHand;
+class UFSHandInstanceRenderer;
+class UMaterialInterface;
+class UStaticMesh;
+enum class EFSOpenXRHandDetail : uint8;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FFSHandTrackingChangedDelegate, UFSInstancedHand*, Hand, bool, bEnabled);
+DECLARE_MULTICAST_DELEGATE_OneParam(FFSHandsUpdatedDelegate, float /* DeltaTime */);
+
+// Keeps track of every UFSInstancedHand of the world and updates the non manual ones in one batch:
+// input data is gathered, poses are processed in parallel, then results are applied on the game thread.
+// Submitted hands are scheduled by significance: far, off-screen or occluded hands get a lower detail level
+// and update rate, and at most MaxHandsPerFrame hands are updated per frame.
+UCLASS()
+class FSOPENXRHANDTRACKING_API UFSHandTrackingSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	struct FHandSchedule
+	{
+		int32 FramesSinceUpdate = 0;
+		float PendingDeltaTime = 0.0f;
+		float Priority = 0.0f;
+	};
+
+	UPROPERTY()
+	TArray<TObjectPtr<UFSInstancedHand>> Hands;
+	// Parallel to Hands.
+	TArray<FHandSchedule> Schedules;
+
+	// Batch of the current frame, reused to avoid allocations.
+	TArray<int32> Candidates;
+	TArray<UFSInstancedHand*> BatchHands;
+	TArray<FXRMotionControllerData> BatchData;
+	TArray<float> BatchDeltaTimes;
+
+	FFSInteractableSet Interactables;
+
+	// One per mesh and material used by hands with bUseSharedRenderer.
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UFSHandInstanceRenderer>> SharedRenderers;
+
+	void UpdateHands(const float DeltaTime);
+	void TraceHandRays();
+	void ScheduleHand(UFSInstancedHand* Hand, FHandSchedule& Schedule, const FVector* ViewLocation) const;
+	int32 GetUpdateInterval(const EFSOpenXRHandDetail Detail) const;
+
+public:
+	// Scheduling of submitted hands, local hands are always updated every frame at full detail.
+	UPROPERTY(BlueprintReadWrite, Category="FSOpenXRHandTracking|Scheduling")
+	bool bScheduleSubmittedHands = true;
+	// Maximum number of hands updated per frame, 0 for no limit. The most significant and stale hands go first.
+	UPROPERTY(BlueprintReadWrite, Category="FSOpenXRHandTracking|Scheduling")
+	int32 MaxHandsPerFrame = 0;
+	// Distance (cm) to the camera from which hands use the Reduced detail level.
+	UPROPERTY(BlueprintReadWrite, Category="FSOpenXRHandTracking|Scheduling")
+	float ReducedDetailDistance = 500.0f;
+	// Distance (cm) to the camera from which hands use the Minimal detail level, as hands that aren't rendered.
+	UPROPERTY(BlueprintReadWrite, Category="FSOpenXRHandTracking|Scheduling")
+	float MinimalDetailDistance = 1500.0f;
+	// Frames between two updates of Reduced and Minimal hands.
+	UPROPERTY(BlueprintReadWrite, Category="FSOpenXRHandTracking|Scheduling")
+	int32 ReducedUpdateInterval = 2;
+	UPROPERTY(BlueprintReadWrite, Category="FSOpenXRHandTracking|Scheduling")
+	int32 MinimalUpdateInterval = 4;
+
+	// Broadcast when any registered hand gains or loses tracking.
+	UPROPERTY(BlueprintAssignable, Category="FSOpenXRHandTracking")
+	FFSHandTrackingChangedDelegate OnHandTrackingChanged;
+	// Broadcast at the end of every tick, once the hands of the batch are updated.
+	FFSHandsUpdatedDelegate OnHandsUpdated;
+
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterHand(UFSInstancedHand* Hand);
+	void UnregisterHand(UFSInstancedHand* Hand);
+
+	UFUNCTION(BlueprintPure, Category="FSOpenXRHandTracking")
+	TArray<UFSInstancedHand*> GetHands() const { return Hands; }
+	const TArray<TObjectPtr<UFSInstancedHand>>& GetRegisteredHands() const { return Hands; }
+
+	// Objects tested by hands with bEnableCollision, their query collision must be enabled.
+	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Collision")
+	void RegisterInteractable(UPrimitiveComponent* Component) { Interactables.Add(Component); }
+	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Collision")
+	void UnregisterInteractable(UPrimitiveComponent* Component) { Interactables.Remove(Component); }
+	const FFSInteractableSet& GetInteractables() const { return Interactables; }
+
+	// Instanced mesh shared by every hand rendering Mesh with Material, created on first use.
+	UFSHandInstanceRenderer* GetSharedRenderer(UStaticMesh* Mesh, UMaterialInterface* Material);
+	const TArray<TObjectPtr<UFSHandInstanceRenderer>>& GetSharedRenderers() const { return SharedRenderers; }
+};
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/MeshComponent.h"
+#include "FSHandSkeleton.h"
+#include "FSHandWireframeComponent.generated.h"
+
+struct FFSHandPoseSnapshot;
+
+// Joint data sent to the render thread each frame, relative to the component location.
+struct FFSHandWireframeJoints
+{
+	FVector3f Locations[FSHandSkeleton::KeypointCount] = {};
+	float Radii[FSHandSkeleton::KeypointCount] = {};
+};
+
+// Renders the whole hand skeleton (palm, bones and joints) with one mesh batch.
+// Indices are built once per style change and only joint positions are sent to the render thread each frame,
+// where the vertices are written once and uploaded to the dynamic mesh buffers of the frame.
+// Uses GEngine->VertexColorMaterial unless a material is set on the component.
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class FSOPENXRHANDTRACKING_API UFSHandWireframeComponent : public UMeshComponent
+{
+	GENERATED_BODY()
+
+	FFSHandWireframeJoints Joints;
+	bool bHasJoints;
+
+public:
+	UFSHandWireframeComponent();
+
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="FSOpenXRHandTracking|Rendering")
+	FColor WireframeColor;
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="FSOpenXRHandTracking|Rendering")
+	float WireframeThickness;
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="FSOpenXRHandTracking|Rendering")
+	bool bRenderWireframePalm;
+	UPROPERTY(BlueprintReadOnly, EditAnywhere, Category="FSOpenXRHandTracking|Rendering")
+	bool bRenderWireframeBones;
+
+	// Rebuilds the render state only when something changed.
+	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Rendering")
+	void SetWireframeStyle(const FColor InColor, const float InThickness, const bool bInRenderPalm,
+	                       const bool bInRenderBones);
+
+	// Moves the component to the palm and sends the joints to the render thread.
+	void UpdatePose(const FFSHandPoseSnapshot& Pose);
+
+	virtual FPrimitiveSceneProxy* CreateSceneProxy() override;
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+	virtual int32 GetNumMaterials() const override { return 1; }
+	virtual UMaterialInterface* GetMaterial(int32 ElementIndex) const override;
+
+protected:
+	virtual void SendRenderDynamicData_Concurrent() override;
+};
@@ -5,9 +5,24 @@
 #include "CoreMinimal.h"
 #include "HeadMountedDisplayTypes.h"
 #include "InputAction.h"
+#include "FSHandPose.h"
+#include "FSHandPoseFilter.h"
+#include "FSHandPoseHistory.h"
+#include "FSHandCollision.h"
+#include "FSPinchDetector.h"
+#include "FSHandPoseRecording.h"
+#include "FSHandPoseArchive.h"
+#include "FSHandPosePipeline.h"
+#include "FSHandTrackingQuality.h"
 #include "Components/InstancedStaticMeshComponent.h"
+#include "WorldCollision.h"
 #include "FSInstancedHand.generated.h"
 
+class UEnhancedInputLocalPlayerSubsystem;
+class UFSHandTrackingSubsystem;
+class UFSHandInstanceRenderer;
+class UFSHandWireframeComponent;
+
 UENUM(BlueprintType)
 enum class EFSOpenXRPinchFingers : uint8
 {
@@ -25,7 +40,33 @@ enum class EFSOpenXRHandRendering : uint8
 	Both UMETA(DisplayName="Both")
 };
 
+UENUM(BlueprintType)
+enum class EFSOpenXRHandUpdateMode : uint8
+{
+	// UpdateHand is called by the user, usually from a Tick function.
+	Manual UMETA(DisplayName="Manual"),
+	// The hand tracking subsystem reads the local tracking data each frame.
+	Tracking UMETA(DisplayName="Tracking"),
+	// The hand tracking subsystem uses the last data given to SubmitHandData (remote hands).
+	Submitted UMETA(DisplayName="Submitted")
+};
+
+UENUM(BlueprintType)
+enum class EFSOpenXRHandDetail : uint8
+{
+	// Every instance and processing stage.
+	Full UMETA(DisplayName="Full"),
+	// Tip instances only, relative rotations and collision are skipped.
+	Reduced UMETA(DisplayName="Reduced"),
+	// Palm instance only, relative rotations and collision are skipped.
+	Minimal UMETA(DisplayName="Minimal")
+};
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FHandTrackingEnabledDelegate, bool, bLeft, bool, bEnabled);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FFSHandRayHoverDelegate, UFSInstancedHand*, Hand, const FHitResult&,
+                                             Hit);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FFSHandContactDelegate, UPrimitiveComponent*, Component, EHandKeypoint,
+                                             Keypoint);
 
 UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
 class FSOPENXRHANDTRACKING_API UFSInstancedHand : public UInstancedStaticMeshComponent
@@ -36,14 +77,65 @@ class FSOPENXRHANDTRACKING_API UFSInstancedHand : public UInstancedStaticMeshCom
 	bool bPreviousHandTracked;
 	FTransform CurrentHandTransform;
 
+	// Last tracked pose, rotations are converted to FRotator on demand.
+	FFSHandJointPose JointPose;
+	FFSHandGestureFeatures GestureFeatures;
 	UPROPERTY()
-	TArray<FVector> BoneLocations;
-	UPROPERTY()
-	TArray<FRotator> BoneRotations;
-	UPROPERTY()
-	TArray<FRotator> BoneRelativeRotations;
-	UPROPERTY()
-	TArray<UInputAction*> InputActions;
+	TObjectPtr<UInputAction> InputActions[FFSPinchDetector::FingerCount];
+
+	FFSHandProcessState ProcessState;
+	uint8 PinchMask;
+	uint8 InjectedPinchMask;
+	float PinchStrengths[FFSPinchDetector::FingerCount];
+	float InjectedPinchValues[FFSPinchDetector::FingerCount];
+	TWeakObjectPtr<UEnhancedInputLocalPlayerSubsystem> InputSubsystem;
+
+	TUniquePtr<FFSHandPoseRecorder> Recorder;
+	TUniquePtr<FFSHandPoseArchiveWriter> ArchiveWriter;
+	// Allocated once when bKeepPoseHistory is enabled.
+	TUniquePtr<FFSHandPoseHistory> PoseHistory;
+
+	FFSHandCollision Collision;
+
+	TWeakObjectPtr<UFSHandTrackingSubsystem> TrackingSubsystem;
+
+	// Synchronous processing result, or the async pipeline when bAsyncProcessing is enabled.
+	FFSHandPoseSnapshot ProcessedPose;
+	TSharedPtr<FFSHandPosePipeline, ESPMode::ThreadSafe> Pipeline;
+	FXRMotionControllerData SubmittedData;
+	double SubmittedTime;
+
+	// Allocated once when bMonitorTrackingQuality is enabled.
+	TUniquePtr<FFSHandTrackingQuality> TrackingQuality;
+
+	// Created on first use of the wireframe rendering.
+	UPROPERTY(Transient)
+	TObjectPtr<UFSHandWireframeComponent> WireframeComponent;
+
+	// Hand ray, the last traced ray is kept to reuse its hit while the pointer barely moves.
+	FTraceDelegate HandRayDelegate;
+	FTraceHandle HandRayTrace;
+	FVector TracedRayStart;
+	FVector TracedRayDirection;
+	FHitResult HandRayHit;
+	bool bHasTracedRay;
+	bool bHandRayHit;
+
+	// Persistent instance pool, one instance per keypoint.
+	TArray<FTransform> InstanceTransforms;
+	bool bInstancesVisible;
+
+	// Block of the shared renderer when bUseSharedRenderer is enabled.
+	TWeakObjectPtr<UFSHandInstanceRenderer> SharedRenderer;
+	int32 SharedBlock;
+
+	// Instance transforms of the last applied pose, instances, wireframe and pointer are left as is until
+	// the pose moves by more than PoseChangeThreshold.
+	FTransform AppliedTransforms[FSHandSkeleton::KeypointCount];
+	bool bPoseApplied;
+	bool bAppliedPersistentInstances;
+	bool bAppliedSharedRenderer;
+	bool bPointerSettled;
 
 public:
 	// Settings
@@ -57,10 +149,60 @@ public:
 	bool bLeftHand;
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Settings")
 	float PinchThreshold;
+	// A pinch is released when the distance goes above this value (hysteresis).
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Settings")
+	float PinchReleaseThreshold;
+	// Distance at which the pinch strength starts to grow from 0 to 1.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Settings")
+	float PinchStrengthDistance;
+	// Inject the pinch strength instead of 1.0 in registered input actions.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Settings")
+	bool bInjectPinchStrength;
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Settings")
 	FTransform FallbackTransform;
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Settings")
 	bool bComputeRelativeRotations;
+	// Keep one instance per bone alive across frames and update them in a single batch.
+	// Hidden bones are masked with a zero scale instead of being removed.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Settings")
+	bool bPersistentInstances;
+	// Manual hands are updated by calling UpdateHand, other modes are batched by UFSHandTrackingSubsystem.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Settings")
+	EFSOpenXRHandUpdateMode UpdateMode;
+	// Process poses on a worker task, the hand uses the latest complete pose (one frame of latency at most).
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Settings")
+	bool bAsyncProcessing;
+	// Keep the recent poses and velocities of the hand, required by motion gestures.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Settings")
+	bool bKeepPoseHistory;
+	// Instances, wireframe and pointer are only updated when a joint moves by more than this distance (cm).
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Settings")
+	float PoseChangeThreshold;
+	// Set by UFSHandTrackingSubsystem for submitted hands depending on their significance.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Settings")
+	EFSOpenXRHandDetail DetailLevel;
+
+	// Collision
+	// Test bone capsules against the interactables of UFSHandTrackingSubsystem.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Collision")
+	bool bEnableCollision;
+	// Contacts are kept without any query while no joint moves more than this distance (cm).
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Collision")
+	float CollisionStaticThreshold;
+	// Called for each bone capsule, a capsule goes from Keypoint to its parent.
+	UPROPERTY(VisibleAnywhere, BlueprintAssignable, Category="FSOpenXRHandTracking|Collision")
+	FFSHandContactDelegate OnContactBegin;
+	UPROPERTY(VisibleAnywhere, BlueprintAssignable, Category="FSOpenXRHandTracking|Collision")
+	FFSHandContactDelegate OnContactEnd;
+
+	// Quality
+	// Keep rolling histograms of jitter, pose age, dropout durations and recovery times, also written to CSV profiles.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Quality")
+	bool bMonitorTrackingQuality;
+
+	// Filtering
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Filtering")
+	FFSHandFilterSettings FilterSettings;
 	
 	// Rendering
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Rendering")
@@ -73,6 +215,13 @@ public:
 	bool bRenderWireframePalm;
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Rendering")
 	bool bRenderWireframeBones;
+	// Render the bones into the instanced mesh shared by every hand using the same mesh and material,
+	// see UFSHandTrackingSubsystem::GetSharedRenderer. This component then has no instances.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Rendering")
+	bool bUseSharedRenderer;
+	// Written in the per-instance custom data of the shared renderer (1-3).
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Rendering")
+	FLinearColor SharedRendererColor;
 
 	// Hand Pointer
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Hand Pointer")
@@ -89,6 +238,23 @@ public:
 	float HandPointerRotationSpeed;
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Hand Pointer")
 	int HandPointerDepth;
+	// Trace along the X axis of the pointer container, asynchronously and batched by UFSHandTrackingSubsystem.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Hand Pointer")
+	bool bTraceHandRay;
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Hand Pointer")
+	float HandRayLength;
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Hand Pointer")
+	TEnumAsByte<ECollisionChannel> HandRayChannel;
+	// The previous hit is kept while the ray moves less than this distance (cm) and angle (degrees).
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Hand Pointer")
+	float HandRayReuseDistance;
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, Category="FSOpenXRHandTracking|Hand Pointer")
+	float HandRayReuseAngle;
+	// Called when the ray starts or stops hitting a component, results arrive one frame after the trace.
+	UPROPERTY(VisibleAnywhere, BlueprintAssignable, Category="FSOpenXRHandTracking|Hand Pointer")
+	FFSHandRayHoverDelegate OnHandRayHoverBegin;
+	UPROPERTY(VisibleAnywhere, BlueprintAssignable, Category="FSOpenXRHandTracking|Hand Pointer")
+	FFSHandRayHoverDelegate OnHandRayHoverEnd;
 
 	// Events
 	UPROPERTY(VisibleAnywhere, BlueprintAssignable)
@@ -96,33 +262,110 @@ public:
 
 	UFSInstancedHand();
 
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+
 	// Public & Blueprint functions
 	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Blueprint")
 	FTransform GetHandTransform() const;
 	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Blueprint")
 	bool UpdateHand(const FXRMotionControllerData& InData, const float DeltaTime);
+	// Data used by the subsystem in the Submitted update mode.
+	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Blueprint")
+	void SubmitHandData(const FXRMotionControllerData& InData);
 	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Blueprint")
 	static void GetDataFromSkeleton(UPoseableMeshComponent* Target, const bool bLeft, FXRMotionControllerData& OutData);
 	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Blueprint")
 	bool IsHandTracked() const;
+	// True when the instances or the wireframe were drawn in the last Tolerance seconds (not off-screen or occluded).
+	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Blueprint")
+	bool WasHandRecentlyRendered(const float Tolerance = 0.2f) const;
 	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Blueprint")
 	bool IsPinching(const EFSOpenXRPinchFingers Finger) const;
 	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Blueprint")
+	float GetPinchStrength(const EFSOpenXRPinchFingers Finger) const;
+	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Blueprint")
 	void RegisterInputAction(const EFSOpenXRPinchFingers Finger, UInputAction* InInputAction);
 	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Blueprint")
 	void RegisterHandRay(USceneComponent* InRayContainer);
+	// Latest hit of the hand ray, when bTraceHandRay is enabled.
+	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Hand Pointer")
+	bool GetHandRayHit(FHitResult& OutHit) const;
 	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Blueprint")
 	FRotator GetBoneRotation(const EHandKeypoint Keypoint) const;
 	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Blueprint")
 	FVector GetBoneLocation(const EHandKeypoint Keypoint) const;
 	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Blueprint")
 	FRotator GetBoneRelativeRotation(const EHandKeypoint Keypoint) const;
+	// World transforms of every keypoint indexed by EHandKeypoint, OutTransforms keeps its allocation.
+	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Blueprint", DisplayName="Get All Bone Transforms")
+	void K2_GetAllBoneTransforms(TArray<FTransform>& OutTransforms) const;
+	// OutTransforms must hold EHandKeypointCount transforms.
+	void GetAllBoneTransforms(TArrayView<FTransform> OutTransforms) const { JointPose.GetTransforms(OutTransforms); }
+
+	// Tracking quality over the last seconds, when bMonitorTrackingQuality is enabled.
+	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Quality")
+	FFSHandQualityStats GetTrackingQuality(const EFSHandQualityMetric Metric) const;
+	// Tracking losses since the monitor was enabled.
+	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Quality")
+	int32 GetDropoutCount() const;
+	const FFSHandTrackingQuality* GetTrackingQualityMonitor() const { return TrackingQuality.Get(); }
+
+	// Recording, every FXRMotionControllerData passed to UpdateHand is written to the capture file.
+	// Use FFSHandPosePlayer to read it back.
+	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Recording")
+	bool StartRecording(const FString& Filename);
+	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Recording")
+	void StopRecording();
+	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Recording")
+	bool IsRecording() const;
+	// Same as recording into a compressed and indexed archive for long sessions, see FFSHandPoseArchiveReader.
+	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Recording")
+	bool StartArchiving(const FString& Filename);
+	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Recording")
+	void StopArchiving();
+	UFUNCTION(BlueprintCallable, Category="FSOpenXRHandTracking|Recording")
+	bool IsArchiving() const;
+
+	// Last tracked pose of the whole hand. Relative rotations are computed when bComputeRelativeRotations is enabled
+	// and DetailLevel is Full, they are identity otherwise.
+	const FFSHandJointPose& GetPoseView() const { return JointPose; }
+	const FFSHandQuatBuffer& GetBoneRelativeQuats() const { return JointPose.RelativeRotations; }
+	// Computed with the relative rotations, on the worker task when bAsyncProcessing is enabled.
+	const FFSHandGestureFeatures& GetGestureFeatures() const { return GestureFeatures; }
+	const FXRMotionControllerData& GetSubmittedData() const { return SubmittedData; }
+	// Components touched by the hand and their keypoint masks, when bEnableCollision is enabled.
+	const TArray<FFSHandCollision::FContact>& GetContacts() const { return Collision.GetContacts(); }
+	// Valid when bKeepPoseHistory is enabled, reset when tracking is lost.
+	const FFSHandPoseHistory* GetPoseHistory() const { return PoseHistory.Get(); }
+	// Valid when bAsyncProcessing is enabled, use SetOnLateLatch_RenderThread to get the freshest pose before rendering.
+	TSharedPtr<FFSHandPosePipeline, ESPMode::ThreadSafe> GetPosePipeline() const { return Pipeline; }
+
+	// UpdateHand is split in two stages so many hands can be processed in parallel.
+	// ProcessHand only touches the pose data of this hand and can run on any thread,
+	// ApplyHand updates instances, inputs and events and must run on the game thread.
+	void ProcessHand(const FXRMotionControllerData& InData);
+	bool ApplyHand(const FXRMotionControllerData& InData, const float DeltaTime);
+
+	// Queues the async trace of the hand ray if it moved enough, called by UFSHandTrackingSubsystem.
+	void TraceHandRay();
 	
 private:
-	void RenderFinger(const FXRMotionControllerData& InData, const EHandKeypoint FingerStart,
-	                  const EHandKeypoint FingerEnd) const;
-	void OverrideInputWithAction(const UInputAction* InInputAction, const float Value) const;
-	static int32 GetParentIndex(EHandKeypoint Keypoint);
+	void UpdateWireframe(const FFSHandPoseSnapshot* Pose, const bool bPoseChanged);
+	void UpdateCollision(const FFSHandPoseSnapshot* Pose);
+	void OnHandRayTraced(const FTraceHandle& Handle, FTraceDatum& Datum);
+	void SetHandRayHit(const FHitResult* Hit);
+	void ConsumePose(const FFSHandPoseSnapshot& Pose);
+	bool UpdateAppliedPose();
+	void UpdatePipeline();
+	void InjectPinchInputs();
+	void ReleasePinchInputs();
+	UEnhancedInputLocalPlayerSubsystem* GetInputSubsystem();
+	void UpdateInstancePool();
+	void HideInstancePool();
+	void UpdateSharedInstances();
+	void HideSharedInstances();
+	void ReleaseSharedBlock();
 
 	static uint8 GetOculusBone(EHandKeypoint Keypoint);
 };
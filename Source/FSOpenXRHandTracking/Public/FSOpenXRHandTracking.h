@@ -5,6 +5,10 @@
 #include "CoreMinimal.h"
 #include "Modules/ModuleManager.h"
 
+FSOPENXRHANDTRACKING_API DECLARE_LOG_CATEGORY_EXTERN(LogFSHandTracking, Log, All);
+
+class FFSHandLateLatchViewExtension;
+
 class FFSOpenXRHandTrackingModule : public IModuleInterface
 {
 public:
@@ -12,4 +16,10 @@ public:
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+	// Created on first use, requires GEngine.
+	TSharedPtr<FFSHandLateLatchViewExtension, ESPMode::ThreadSafe> GetLateLatchViewExtension();
+
+private:
+	TSharedPtr<FFSHandLateLatchViewExtension, ESPMode::ThreadSafe> LateLatchViewExtension;
 };
@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Edge-triggered pinch state machine for the 4 fingers facing the thumb.
+// A finger starts pinching under PressThreshold and stops above ReleaseThreshold.
+struct FSOPENXRHANDTRACKING_API FFSPinchDetector
+{
+	static constexpr int32 FingerCount = 4;
+
+	FFSPinchDetector();
+
+	// Positions must contain every hand keypoint. Thresholds are distances in world units.
+	void Update(TConstArrayView<FVector> Positions, const float PressThreshold, const float ReleaseThreshold,
+	            const float StrengthDistance);
+	void Reset();
+
+	FORCEINLINE bool IsPinching(const int32 Finger) const { return (PinchMask & (1 << Finger)) != 0; }
+	// 0 when the finger is further than StrengthDistance, 1 when pinching under PressThreshold.
+	FORCEINLINE float GetStrength(const int32 Finger) const { return Strengths[Finger]; }
+	FORCEINLINE float GetDistanceSquared(const int32 Finger) const { return DistancesSquared[Finger]; }
+
+	// Fingers which started or stopped pinching during the last update.
+	FORCEINLINE uint8 GetPressedMask() const { return PressedMask; }
+	FORCEINLINE uint8 GetReleasedMask() const { return ReleasedMask; }
+	FORCEINLINE uint8 GetPinchMask() const { return PinchMask; }
+
+private:
+	float DistancesSquared[FingerCount];
+	float Strengths[FingerCount];
+	uint8 PinchMask;
+	uint8 PressedMask;
+	uint8 ReleasedMask;
+};
@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HeadMountedDisplayTypes.h"
+#include "FSHandSkeleton.h"
+
+class USkinnedAsset;
+class USkinnedMeshComponent;
+
+// Keypoint to bone index mapping of a skinned asset, resolved once so the per-frame path never looks up names.
+struct FSOPENXRHANDTRACKING_API FFSSkeletonBinding
+{
+	TWeakObjectPtr<const USkinnedAsset> Asset;
+	// INDEX_NONE when the bone doesn't exist in the asset.
+	int32 BoneIndices[FSHandSkeleton::KeypointCount];
+
+	// Binding of the asset used by Target, created on first use with GetBoneName(Keypoint).
+	// Game thread only, the pointer is valid until the next call. Returns nullptr if Target has no asset.
+	static const FFSSkeletonBinding* Find(const USkinnedMeshComponent* Target,
+	                                      TFunctionRef<FName(int32 Keypoint)> GetBoneName);
+
+	// Writes the world space keypoints of Target, output arrays are only resized when their size differs.
+	void ReadWorldSpace(const USkinnedMeshComponent* Target, FXRMotionControllerData& OutData) const;
+};
@@ -0,0 +1,24 @@
+// Copyright Epic Games, Inc. All Rights Reserved.
+
+using UnrealBuildTool;
+
+public class FSOpenXRHandTrackingEditor : ModuleRules
+{
+	public FSOpenXRHandTrackingEditor(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = ModuleRules.PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(new []
+		{
+			"Core",
+			"AnimGraph",
+			"FSOpenXRHandTracking"
+		});
+
+		PrivateDependencyModuleNames.AddRange(new [] {
+			"CoreUObject",
+			"Engine",
+			"BlueprintGraph"
+		});
+	}
+}
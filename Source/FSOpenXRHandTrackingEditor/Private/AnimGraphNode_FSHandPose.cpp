@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AnimGraphNode_FSHandPose.h"
+
+#define LOCTEXT_NAMESPACE "FSOpenXRHandTrackingEditor"
+
+FText UAnimGraphNode_FSHandPose::GetNodeTitle(ENodeTitleType::Type TitleType) const
+{
+	return LOCTEXT("FSHandPoseTitle", "FS Hand Pose");
+}
+
+FText UAnimGraphNode_FSHandPose::GetTooltipText() const
+{
+	return LOCTEXT("FSHandPoseTooltip",
+	               "Drives the finger bones with the relative rotations of a FSInstancedHand (bComputeRelativeRotations).");
+}
+
+FLinearColor UAnimGraphNode_FSHandPose::GetNodeTitleColor() const
+{
+	return FLinearColor(0.7f, 0.7f, 0.7f);
+}
+
+FString UAnimGraphNode_FSHandPose::GetNodeCategory() const
+{
+	return TEXT("FSOpenXRHandTracking");
+}
+
+#undef LOCTEXT_NAMESPACE
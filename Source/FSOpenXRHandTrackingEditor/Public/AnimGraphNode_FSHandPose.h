@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AnimGraphNode_Base.h"
+#include "AnimNode_FSHandPose.h"
+#include "AnimGraphNode_FSHandPose.generated.h"
+
+UCLASS()
+class FSOPENXRHANDTRACKINGEDITOR_API UAnimGraphNode_FSHandPose : public UAnimGraphNode_Base
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category=Settings)
+	FAnimNode_FSHandPose Node;
+
+public:
+	// UEdGraphNode interface
+	virtual FText GetNodeTitle(ENodeTitleType::Type TitleType) const override;
+	virtual FText GetTooltipText() const override;
+	virtual FLinearColor GetNodeTitleColor() const override;
+
+	// UAnimGraphNode_Base interface
+	virtual FString GetNodeCategory() const override;
+};